@@ -0,0 +1,195 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "async.h"
+
+namespace srdp {
+
+  AsyncSrdp::AsyncSrdp(Srdp& srdpin, unsigned threads, size_t max_pendingin) :
+    srdp(srdpin),
+    max_pending(max_pendingin)
+  {
+    if (threads == 0)
+      threads = std::max(1u, std::thread::hardware_concurrency());
+
+    if (max_pending == 0)
+      max_pending = 4 * threads;
+
+    for (unsigned i=0; i < threads; i++)
+      workers.emplace_back(&AsyncSrdp::work, this);
+  }
+
+  AsyncSrdp::~AsyncSrdp(){
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    has_work.notify_all();
+
+    for (auto& w : workers)
+      w.join();
+  }
+
+  void AsyncSrdp::work(){
+    while (true) {
+      std::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        has_work.wait(lock, [this]() { return stopping || !queue.empty(); });
+
+        if (queue.empty()) break;
+
+        job = std::move(queue.front());
+        queue.pop_front();
+      }
+      has_room.notify_one();
+
+      // Errors are passed on through the futures
+      job();
+    }
+
+    srdp.close_session();
+  }
+
+  void AsyncSrdp::post(std::function<void()> job){
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      has_room.wait(lock, [this]() { return queue.size() < max_pending; });
+      queue.push_back(std::move(job));
+    }
+    has_work.notify_one();
+  }
+
+  std::future<File> AsyncSrdp::add_file(const std::string& project, const std::string& experiment,
+      const fs::path& name, File::role_t role, const CancelToken& token){
+
+    // Relative paths must not depend on the working directory at run time
+    const fs::path path = fs::absolute(name);
+
+    return submit([this, project, experiment, path, role]() {
+        return srdp.add_file(project, experiment, path, role);
+      }, token);
+  }
+
+  void AsyncSrdp::add_file(const std::string& project, const std::string& experiment,
+      const fs::path& name, File::role_t role, done_t<File> done, const CancelToken& token){
+
+    const fs::path path = fs::absolute(name);
+
+    submit([this, project, experiment, path, role]() {
+        return srdp.add_file(project, experiment, path, role);
+      }, std::move(done), token);
+  }
+
+  std::future<void> AsyncSrdp::verify(const VerifyOptions& opts, const CancelToken& token){
+    return submit([this, opts]() { srdp.verify(opts); }, token);
+  }
+
+  void AsyncSrdp::verify(const VerifyOptions& opts, done_t<void> done, const CancelToken& token){
+    submit([this, opts]() { srdp.verify(opts); }, std::move(done), token);
+  }
+
+  AsyncSrdp::FileStream AsyncSrdp::list_files(const std::string& project, const std::string& experiment,
+      size_t page_size, const CancelToken& token){
+
+    if (page_size == 0)
+      throw std::invalid_argument("Page size must not be 0");
+
+    FileStream stream;
+    auto state = stream.state;
+
+    auto read = [this, state, project, experiment, page_size, token]() {
+      try {
+        File file = srdp.get_file(project, experiment);
+
+        PageOptions page;
+        page.limit = page_size;
+
+        while (true) {
+          {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->changed.wait(lock, [&]() {
+                return state->closed || token.is_cancelled() || state->files.size() < page_size; });
+            if (state->closed) return;
+          }
+
+          token.check();
+
+          // The read transaction ends with the page
+          auto files = file.list(page);
+          if (!files.empty())
+            page.after = files.back().cursor(page.sort);
+
+          const bool done = files.size() < page_size;
+          std::function<void()> ready;
+          {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            for (auto& f : files)
+              state->files.push_back(std::move(f));
+
+            state->done = done;
+            ready = state->notify();
+          }
+          if (ready) ready();
+
+          if (done) return;
+        }
+      } catch (...) {
+        std::function<void()> ready;
+        {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          state->error = std::current_exception();
+          state->done = true;
+          ready = state->notify();
+        }
+        if (ready) ready();
+      }
+    };
+
+    // Errors and cancellation reach the reader through the stream
+    submit(read);
+
+    return stream;
+  }
+
+  AsyncSrdp::FileStream::~FileStream(){
+    if (!state) return; // moved from
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->closed = true;
+    state->ready = nullptr;
+    state->changed.notify_all();
+  }
+
+  std::optional<File> AsyncSrdp::FileStream::next(){
+    if (!state) return std::nullopt; // moved from
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->changed.wait(lock, [this]() { return !state->files.empty() || state->done; });
+
+    if (!state->files.empty()) {
+      File f = std::move(state->files.front());
+      state->files.pop_front();
+      state->changed.notify_all();
+      return f;
+    }
+
+    if (state->error)
+      std::rethrow_exception(state->error);
+
+    return std::nullopt;
+  }
+
+  void AsyncSrdp::FileStream::on_ready(std::function<void()> ready){
+    if (state) {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (state->files.empty() && !state->done) {
+        state->ready = std::move(ready);
+        return;
+      }
+    }
+
+    ready();
+  }
+}
@@ -0,0 +1,201 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_ASYNC_H
+#define SRDP_ASYNC_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <thread>
+#include <utility>
+
+#include "srdp.h"
+
+namespace srdp {
+
+  // Thrown by operations that were cancelled before they finished
+  class cancelled_error : public std::runtime_error {
+    public:
+      cancelled_error() : std::runtime_error("Operation cancelled") {}
+  };
+
+  /**
+   * Cancels the operations it is passed to.
+   * Copies share the state.
+   */
+  class CancelToken {
+    private:
+      std::shared_ptr<std::atomic<bool>> flag = std::make_shared<std::atomic<bool>>(false);
+
+    public:
+      void cancel() { *flag = true; }
+      bool is_cancelled() const { return *flag; }
+
+      // Throws cancelled_error if cancelled
+      void check() const { if (is_cancelled()) throw cancelled_error(); }
+  };
+
+  /**
+   * Asynchronous interface to Srdp.
+   *
+   * Operations run on a fixed number of worker threads and return
+   * futures, or pass the ready future to a completion callback on the
+   * worker, e.g. to resume a coroutine without blocking a thread in
+   * get(). At most max_pending operations wait for a worker, submitting
+   * more blocks the caller until there is room (backpressure).
+   * The store work of add_file (hashing, copying) runs in parallel,
+   * the DB writes are serialized by Srdp.
+   *
+   * An operation cancelled before it has started fails with
+   * cancelled_error. Started operations run to their end, except
+   * list_files, which stops before reading the next page.
+   *
+   * Objects returned hold the DB connection of a worker thread,
+   * only their data members may be used.
+   */
+  class AsyncSrdp {
+    public:
+      /**
+       * Files of an experiment, read page by page by a worker.
+       *
+       * The worker reads the next page once less than a page is
+       * buffered. Destroying the stream stops the worker.
+       */
+      class FileStream {
+        private:
+          struct state_t {
+            std::mutex mutex;
+            std::condition_variable changed;
+            std::deque<File> files;
+            bool done = false;   // all files read
+            bool closed = false; // reader is gone
+            std::exception_ptr error;
+            std::function<void()> ready; // see on_ready
+
+            // Wake the reader, returns the callback to run without the lock
+            std::function<void()> notify(){
+              changed.notify_all();
+              return std::exchange(ready, nullptr);
+            }
+          };
+
+          std::shared_ptr<state_t> state;
+
+          friend class AsyncSrdp;
+
+        public:
+          FileStream() : state(std::make_shared<state_t>()) {}
+          FileStream(FileStream&&) = default;
+          FileStream& operator=(FileStream&&) = default;
+          ~FileStream();
+
+          /**
+           * Next file, nothing at the end of the list
+           * or of a moved-from stream.
+           * Re-throws the error of the worker.
+           */
+          std::optional<File> next();
+
+          /**
+           * Call ready once next() does not block, i.e. a file is
+           * buffered, or the list has ended or failed.
+           * Runs ready at once if that is already the case, otherwise on
+           * the worker. Only the last callback set is kept, destroying
+           * the stream drops it.
+           */
+          void on_ready(std::function<void()> ready);
+      };
+
+      // Receives the ready future of an operation, must not throw
+      template<class T>
+      using done_t = std::function<void(std::future<T>)>;
+
+    private:
+      Srdp& srdp;
+      size_t max_pending;
+
+      std::mutex mutex;
+      std::condition_variable has_work;
+      std::condition_variable has_room;
+      std::deque<std::function<void()>> queue;
+      bool stopping = false;
+      std::vector<std::thread> workers;
+
+      void work();
+
+      // Blocks while the queue is full
+      void post(std::function<void()> job);
+
+    public:
+      /* Start the workers.
+       *
+       * threads = 0 selects the number of hardware threads,
+       * max_pending = 0 allows four queued operations per thread.
+       */
+      AsyncSrdp(Srdp& srdp, unsigned threads = 0, size_t max_pending = 0);
+
+      // Runs the queued operations and stops the workers
+      ~AsyncSrdp();
+
+      AsyncSrdp(const AsyncSrdp&) = delete;
+      AsyncSrdp& operator=(const AsyncSrdp&) = delete;
+
+      // Run any function on a worker
+      template<class F>
+      std::future<std::invoke_result_t<F>> submit(F&& f, const CancelToken& token = CancelToken()){
+        using result_t = std::invoke_result_t<F>;
+
+        auto task = std::make_shared<std::packaged_task<result_t()>>(
+            [f = std::forward<F>(f), token]() mutable {
+              token.check();
+              return f();
+            });
+
+        auto result = task->get_future();
+        post([task]() { (*task)(); });
+
+        return result;
+      }
+
+      // Run any function on a worker, done is called on the worker when it has finished
+      template<class F>
+      void submit(F&& f, done_t<std::invoke_result_t<F>> done, const CancelToken& token = CancelToken()){
+        using result_t = std::invoke_result_t<F>;
+
+        auto task = std::make_shared<std::packaged_task<result_t()>>(
+            [f = std::forward<F>(f), token]() mutable {
+              token.check();
+              return f();
+            });
+
+        post([task, done = std::move(done)]() {
+            auto result = task->get_future();
+            (*task)();
+            done(std::move(result));
+          });
+      }
+
+      std::future<File> add_file(const std::string& project, const std::string& experiment,
+          const fs::path& name, File::role_t role, const CancelToken& token = CancelToken());
+
+      void add_file(const std::string& project, const std::string& experiment,
+          const fs::path& name, File::role_t role, done_t<File> done, const CancelToken& token = CancelToken());
+
+      std::future<void> verify(const VerifyOptions& opts = VerifyOptions(), const CancelToken& token = CancelToken());
+      void verify(const VerifyOptions& opts, done_t<void> done, const CancelToken& token = CancelToken());
+
+      /* Stream the files of an experiment.
+       *
+       * The stream occupies a worker until it is read to its end,
+       * cancelled, or destroyed.
+       */
+      FileStream list_files(const std::string& project = std::string(), const std::string& experiment = std::string(),
+          size_t page_size = 1000, const CancelToken& token = CancelToken());
+  };
+}
+
+#endif /* SRDP_ASYNC_H */
@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <fstream>
+#include <set>
+#include <catch2/catch_test_macros.hpp>
+
+#include "async.h"
+
+TEST_CASE("Asynchronous interface", "[async]") {
+  const fs::path base_dir = fs::absolute("test_async");
+  auto old_cwd = fs::current_path();
+
+  fs::remove_all(base_dir);
+  fs::create_directory(base_dir);
+  fs::current_path(base_dir);
+
+  REQUIRE_NOTHROW( srdp::Srdp::init("./") );
+
+  srdp::Srdp dp;
+  dp.create_project("project");
+  dp.create_experiment("exp");
+
+  const int nfiles = 50;
+  for (int i=0; i < nfiles; i++)
+    std::ofstream("f" + std::to_string(i)) << "content " << i;
+
+  {
+    srdp::AsyncSrdp async(dp, 4, 2);
+
+    // Files are added in parallel
+    std::vector<std::future<srdp::File>> added;
+    for (int i=0; i < nfiles; i++)
+      added.push_back(async.add_file("", "exp", "f" + std::to_string(i), srdp::File::role_t::input));
+
+    for (int i=0; i < nfiles; i++)
+      REQUIRE( added[i].get().path == "f" + std::to_string(i) );
+
+    REQUIRE( dp.get_file("", "exp").list().size() == nfiles );
+
+    // Errors are passed on
+    auto missing = async.add_file("", "exp", "missing", srdp::File::role_t::input);
+    REQUIRE_THROWS( missing.get() );
+
+    auto result = async.submit([]() { return 42; });
+    REQUIRE( result.get() == 42 );
+
+    // Completion callbacks get the ready future on the worker
+    auto answer = std::make_shared<std::promise<int>>();
+    async.submit([]() { return 42; }, [answer](std::future<int> f) { answer->set_value(f.get()); });
+    REQUIRE( answer->get_future().get() == 42 );
+
+    std::ofstream("g") << "g";
+    auto file_added = std::make_shared<std::promise<std::string>>();
+    async.add_file("", "exp", "g", srdp::File::role_t::input, [file_added](std::future<srdp::File> f) {
+        try { file_added->set_value(*f.get().path); } catch (...) { file_added->set_exception(std::current_exception()); }
+      });
+    REQUIRE( file_added->get_future().get() == "g" );
+    dp.unlink_file("", "exp", "g");
+
+    // Cancelled before it has started
+    srdp::CancelToken token;
+    token.cancel();
+    std::ofstream("late") << "late";
+    auto cancelled = async.add_file("", "exp", "late", srdp::File::role_t::input, token);
+    REQUIRE_THROWS_AS( cancelled.get(), srdp::cancelled_error );
+    REQUIRE( dp.get_file("", "exp").list().size() == nfiles );
+
+    // Streamed in pages
+    {
+      auto stream = async.list_files("", "exp", 7);
+      std::set<std::string> paths;
+      while (auto f = stream.next())
+        paths.insert(*f->path);
+
+      REQUIRE( paths.size() == nfiles );
+    }
+
+    // Read without blocking, resumed by the stream
+    {
+      auto stream = async.list_files("", "exp", 7);
+      size_t count = 0;
+      while (true) {
+        auto ready = std::make_shared<std::promise<void>>();
+        stream.on_ready([ready]() { ready->set_value(); });
+        ready->get_future().wait();
+
+        if (!stream.next()) break;
+        count++;
+      }
+
+      REQUIRE( count == nfiles );
+    }
+
+    {
+      srdp::CancelToken stop;
+      auto stream = async.list_files("", "exp", 7, stop);
+      REQUIRE( stream.next() );
+
+      stop.cancel();
+      REQUIRE_THROWS_AS( [&]() { while (stream.next()); }(), srdp::cancelled_error );
+    }
+
+    // The list moves with the stream
+    {
+      auto stream = async.list_files("", "exp", 7);
+      auto moved = std::move(stream);
+      REQUIRE_FALSE( stream.next() );
+      REQUIRE( moved.next() );
+    }
+
+    // An abandoned stream frees its worker
+    for (int i=0; i < 8; i++) {
+      auto stream = async.list_files("", "exp", 3);
+      REQUIRE( stream.next() );
+    }
+    REQUIRE( async.submit([]() { return true; }).get() );
+
+    REQUIRE_NOTHROW( async.verify().get() );
+  }
+
+  fs::current_path(old_cwd);
+  REQUIRE_NOTHROW( fs::remove_all(base_dir) );
+}
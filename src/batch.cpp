@@ -0,0 +1,384 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cctype>
+
+#include "batch.h"
+
+namespace srdp {
+
+  namespace {
+    // Command failed, but its changes up to the failure are kept
+    class partial_error : public std::runtime_error {
+      public:
+        using std::runtime_error::runtime_error;
+    };
+
+    void append_utf8(std::string& out, unsigned cp){
+      if (cp < 0x80) {
+        out += char(cp);
+      } else if (cp < 0x800) {
+        out += char(0xc0 | (cp >> 6));
+        out += char(0x80 | (cp & 0x3f));
+      } else if (cp < 0x10000) {
+        out += char(0xe0 | (cp >> 12));
+        out += char(0x80 | ((cp >> 6) & 0x3f));
+        out += char(0x80 | (cp & 0x3f));
+      } else {
+        out += char(0xf0 | (cp >> 18));
+        out += char(0x80 | ((cp >> 12) & 0x3f));
+        out += char(0x80 | ((cp >> 6) & 0x3f));
+        out += char(0x80 | (cp & 0x3f));
+      }
+    }
+
+    // JSON array of strings
+    std::vector<std::string> split_json(const std::string& line){
+      size_t pos = 0;
+
+      auto fail = [&line]() {
+        throw std::invalid_argument("Invalid JSON command: " + line);
+      };
+      auto skip_space = [&]() {
+        while (pos < line.size() && std::isspace(static_cast<unsigned char>(line[pos]))) pos++;
+      };
+      auto hex4 = [&]() {
+        if (pos + 4 > line.size()) fail();
+        unsigned value = 0;
+        for (int i=0; i < 4; i++) {
+          const char c = line[pos++];
+          value <<= 4;
+          if (c >= '0' && c <= '9') value |= c - '0';
+          else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+          else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+          else fail();
+        }
+        return value;
+      };
+
+      std::vector<std::string> words;
+
+      skip_space();
+      if (pos >= line.size() || line[pos] != '[') fail();
+      pos++;
+      skip_space();
+
+      if (pos < line.size() && line[pos] == ']') {
+        pos++;
+      } else {
+        for (;;) {
+          skip_space();
+          if (pos >= line.size() || line[pos] != '"') fail();
+          pos++;
+
+          std::string word;
+          for (;;) {
+            if (pos >= line.size()) fail();
+            const char c = line[pos++];
+            if (c == '"') break;
+            if (c != '\\') {
+              word += c;
+              continue;
+            }
+
+            if (pos >= line.size()) fail();
+            switch (line[pos++]) {
+              case '"':  word += '"'; break;
+              case '\\': word += '\\'; break;
+              case '/':  word += '/'; break;
+              case 'b':  word += '\b'; break;
+              case 'f':  word += '\f'; break;
+              case 'n':  word += '\n'; break;
+              case 'r':  word += '\r'; break;
+              case 't':  word += '\t'; break;
+              case 'u': {
+                unsigned cp = hex4();
+                // Surrogate pair
+                if (cp >= 0xd800 && cp < 0xdc00) {
+                  if (line.compare(pos, 2, "\\u") != 0) fail();
+                  pos += 2;
+                  const unsigned low = hex4();
+                  if (low < 0xdc00 || low >= 0xe000) fail();
+                  cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                }
+                append_utf8(word, cp);
+                break;
+              }
+              default:
+                fail();
+            }
+          }
+          words.push_back(word);
+
+          skip_space();
+          if (pos < line.size() && line[pos] == ',') {
+            pos++;
+          } else if (pos < line.size() && line[pos] == ']') {
+            pos++;
+            break;
+          } else
+            fail();
+        }
+      }
+
+      skip_space();
+      if (pos != line.size()) fail();
+
+      return words;
+    }
+
+    // Join the remaining words to a text
+    std::string join(const std::vector<std::string>& args, size_t first){
+      std::string text;
+      for (size_t i=first; i < args.size(); i++) {
+        if (i > first) text += " ";
+        text += args[i];
+      }
+      return text;
+    }
+
+    // Journal entry as composed by dp project/experiment append
+    std::string journal_text(const std::vector<std::string>& args){
+      return "\n### " + Srdp::get_time_stamp_fmt() + "\n\n" + join(args, 2);
+    }
+  }
+
+  Batch::Batch(Srdp& srdp_in, size_t batch_size_in, const std::string& project_in, const std::string& experiment_in) :
+    srdp(srdp_in), batch_size(batch_size_in), project(project_in), experiment(experiment_in)
+  {
+    if (batch_size == 0)
+      throw std::invalid_argument("Batch size must be at least 1");
+  }
+
+  std::vector<std::string> Batch::split(const std::string& line){
+    size_t first = 0;
+    while (first < line.size() && std::isspace(static_cast<unsigned char>(line[first]))) first++;
+
+    if (first < line.size() && line[first] == '[')
+      return split_json(line);
+
+    std::vector<std::string> words;
+    std::string word;
+    bool in_word = false;
+    char quote = 0;
+
+    for (size_t i=first; i < line.size(); i++) {
+      const char c = line[i];
+
+      if (quote) {
+        if (c == quote)
+          quote = 0;
+        else if (c == '\\' && quote == '"' && i + 1 < line.size())
+          word += line[++i];
+        else
+          word += c;
+      } else if (c == '\'' || c == '"') {
+        quote = c;
+        in_word = true;
+      } else if (c == '\\' && i + 1 < line.size()) {
+        word += line[++i];
+        in_word = true;
+      } else if (std::isspace(static_cast<unsigned char>(c))) {
+        if (in_word) words.push_back(word);
+        word.clear();
+        in_word = false;
+      } else {
+        word += c;
+        in_word = true;
+      }
+    }
+
+    if (quote)
+      throw std::invalid_argument("Unterminated quote: " + line);
+
+    if (in_word) words.push_back(word);
+
+    return words;
+  }
+
+  size_t Batch::run(std::istream& in, const result_cb_t& result, const std::function<void()>& committed){
+    std::vector<result_t> pending;
+    size_t failed = 0;
+    size_t line_no = 0;
+    bool open = false;
+    std::string line;
+
+    // Results are only reported once they are committed
+    auto commit = [&]() {
+      srdp.release("batch");
+      open = false;
+
+      if (result)
+        for (const auto& r : pending) result(r);
+      pending.clear();
+
+      if (committed) committed();
+    };
+
+    try {
+      while (std::getline(in, line)) {
+        line_no++;
+
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+
+        if (!open) {
+          srdp.savepoint("batch");
+          open = true;
+        }
+
+        result_t r{line_no, false, ""};
+
+        std::vector<std::string> args;
+        try {
+          args = split(line);
+        } catch (std::invalid_argument& e) {
+          r.message = e.what();
+        }
+
+        if (r.message.empty()) r = run_command(args, line_no);
+
+        if (!r.ok) failed++;
+        pending.push_back(r);
+
+        if (pending.size() >= batch_size) commit();
+      }
+
+      if (open) commit();
+    } catch (...) {
+      if (open) srdp.rollback("batch");
+      throw;
+    }
+
+    return failed;
+  }
+
+  Batch::result_t Batch::run_command(const std::vector<std::string>& args, size_t line){
+    result_t r{line, true, ""};
+
+    srdp.savepoint("command");
+    try {
+      r.message = execute(args);
+      srdp.release("command");
+    } catch (partial_error& e) {
+      srdp.release("command");
+      r.ok = false;
+      r.message = e.what();
+    } catch (std::exception& e) {
+      srdp.rollback("command");
+      r.ok = false;
+      r.message = e.what();
+    }
+
+    return r;
+  }
+
+  std::string Batch::execute(const std::vector<std::string>& args){
+    if (args.size() < 2)
+      throw std::invalid_argument("Incomplete command");
+
+    const std::string& scope = args[0];
+    const std::string& cmd = args[1];
+
+    if (scope == "file" || scope == "f") {
+      if (cmd == "add" || cmd == "a") {
+        if (args.size() < 4)
+          throw std::invalid_argument("No role/path given");
+
+        const File::role_t role = File::string_to_role(args[2]);
+        if (role == File::role_t::none)
+          throw std::invalid_argument("Invalid role");
+
+        const std::vector<fs::path> paths(args.begin() + 3, args.end());
+
+        // Check all paths first, added files can not be rolled back
+        for (const auto& p : paths) {
+          if (!fs::is_regular_file(p))
+            throw std::invalid_argument("Not a regular file: " + p.string());
+          if (!srdp.path_is_in_dir(p))
+            throw std::invalid_argument("File not in project directory: " + p.string());
+        }
+
+        const auto exp = srdp.open_experiment(experiment, project);
+
+        std::vector<File> files;
+        try {
+          files = srdp.add_files(exp, paths, role);
+        } catch (std::exception& e) {
+          throw partial_error(std::string(e.what()) + " (files before it were added)");
+        }
+
+        std::string msg;
+        for (const auto& f : files) {
+          if (!msg.empty()) msg += ", ";
+          msg += "added " + f.path.value_or("") + " (" + scas::Hash::convert_hash_to_string(f.hash) + ")";
+        }
+        return msg;
+
+      } else if (cmd == "unlink" || cmd == "u") {
+        if (args.size() != 3)
+          throw std::invalid_argument("No path/hash given");
+
+        // Same output as dp file unlink
+        const auto file = srdp.load_file(project, experiment, args[2]);
+        const std::string msg = "Remove " + File::role_to_string(*file.role) + " " + file.path.value_or("")
+          + " (" + scas::Hash::convert_hash_to_string(file.hash) + ")";
+
+        srdp.unlink_file(project, experiment, args[2]);
+        return msg;
+      }
+
+    } else if (scope == "experiment" || scope == "e") {
+      if (cmd == "create" || cmd == "c") {
+        if (args.size() != 3)
+          throw std::invalid_argument("No name given");
+
+        auto exp = srdp.create_experiment(args[2], project);
+        exp.ctime = get_timestamp_now();
+        exp.owner = Srdp::get_user_name();
+        srdp.update_experiment(exp);
+
+        // Following commands work on the new experiment
+        experiment = uuids::to_string(exp.uuid);
+        return "created " + exp.name + " (" + experiment + ")";
+
+      } else if (cmd == "set" || cmd == "s") {
+        if (args.size() != 3)
+          throw std::invalid_argument("No name given");
+
+        auto exp = srdp.open_experiment(args[2], project);
+        srdp.get_config().set_experiment(exp.uuid);
+
+        experiment = uuids::to_string(exp.uuid);
+        return "set " + exp.name + " (" + experiment + ")";
+
+      } else if (cmd == "abstract" || cmd == "m") {
+        auto exp = srdp.open_experiment(experiment, project);
+        exp.metadata = join(args, 2);
+        srdp.update_experiment(exp);
+        return "abstract of " + exp.name + " set";
+
+      } else if (cmd == "append" || cmd == "a") {
+        auto exp = srdp.open_experiment(experiment, project);
+        exp.journal().append(journal_text(args), Srdp::get_user_name());
+        return "journal of " + exp.name + " appended";
+      }
+
+    } else if (scope == "project" || scope == "p") {
+      if (cmd == "abstract" || cmd == "m") {
+        auto prj = srdp.open_project(project);
+        prj.metadata = join(args, 2);
+        srdp.update_project(prj);
+        return "abstract of " + prj.name + " set";
+
+      } else if (cmd == "append" || cmd == "a") {
+        auto prj = srdp.open_project(project);
+        prj.journal().append(journal_text(args), Srdp::get_user_name());
+        return "journal of " + prj.name + " appended";
+      }
+    }
+
+    throw std::invalid_argument("Unknown command: " + scope + " " + cmd);
+  }
+}
@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_BATCH_H
+#define SRDP_BATCH_H
+
+#include <istream>
+
+#include "srdp.h"
+
+namespace srdp {
+
+  /**
+   * Run many commands against one open Srdp.
+   *
+   * Each input line is one command, either as words (quotes and
+   * backslash escapes as in a shell) or as a JSON array of strings:
+   *
+   *   file add <role> <path> [path [...]]
+   *   file unlink <path|hash>
+   *   experiment create <name>
+   *   experiment set <name|uuid>
+   *   project|experiment abstract <text>
+   *   project|experiment append <text>
+   *
+   * Empty lines and lines starting with '#' are skipped.
+   * Commands are committed in groups of batch_size. A failing command
+   * is rolled back alone and does not stop the batch.
+   */
+  class Batch {
+    public:
+      struct result_t {
+        size_t line;         // input line of the command
+        bool ok;
+        std::string message; // result or error
+      };
+
+      using result_cb_t = std::function<void(const result_t& result)>;
+
+    private:
+      Srdp& srdp;
+      size_t batch_size;
+
+      // Selection for the commands, name or uuid, empty = active
+      std::string project;
+      std::string experiment;
+
+    public:
+      Batch(Srdp& srdp, size_t batch_size = 1000,
+          const std::string& project = std::string(), const std::string& experiment = std::string());
+
+      // Split a command line into words
+      static std::vector<std::string> split(const std::string& line);
+
+      /**
+       * Execute all commands of the input.
+       *
+       * result is called for every command after its group is committed,
+       * committed after each group. Returns the number of failed commands.
+       */
+      size_t run(std::istream& in, const result_cb_t& result,
+          const std::function<void()>& committed = std::function<void()>());
+
+      /**
+       * Execute a single command in its own savepoint.
+       * Only the changes of a failed command are rolled back.
+       */
+      result_t run_command(const std::vector<std::string>& args, size_t line = 0);
+
+      /**
+       * Execute a single command in the current transaction.
+       * Returns a message about the result, throws on error.
+       */
+      std::string execute(const std::vector<std::string>& args);
+  };
+}
+
+#endif /* SRDP_BATCH_H */
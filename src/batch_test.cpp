@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <fstream>
+#include <sstream>
+#include <catch2/catch_test_macros.hpp>
+
+#include "batch.h"
+
+const std::string batch_dir = "test_batch";
+
+TEST_CASE("Split batch commands", "[batch]") {
+  using words = std::vector<std::string>;
+
+  REQUIRE( srdp::Batch::split("file add input a b") == words{"file", "add", "input", "a", "b"} );
+  REQUIRE( srdp::Batch::split("  p append 'two words' \"x \\\"y\\\"\" a\\ b") ==
+      words{"p", "append", "two words", "x \"y\"", "a b"} );
+  REQUIRE( srdp::Batch::split("e create ''") == words{"e", "create", ""} );
+  REQUIRE_THROWS( srdp::Batch::split("e create 'open") );
+
+  REQUIRE( srdp::Batch::split(R"( ["e", "append", "a\nb \"c\" ä 😀"] )") ==
+      words{"e", "append", "a\nb \"c\" \xc3\xa4 \xf0\x9f\x98\x80"} );
+  REQUIRE( srdp::Batch::split("[]").empty() );
+  REQUIRE_THROWS( srdp::Batch::split("[\"e\", 1]") );
+  REQUIRE_THROWS( srdp::Batch::split("[\"e\"") );
+  REQUIRE_THROWS( srdp::Batch::split("[\"e\"] x") );
+}
+
+TEST_CASE("Run batch commands", "[batch]") {
+  auto old_cwd = fs::current_path();
+  fs::remove_all(batch_dir);
+  fs::create_directory(batch_dir);
+  fs::current_path(batch_dir);
+
+  REQUIRE_NOTHROW( srdp::Srdp::init("./") );
+
+  {
+    srdp::Srdp dp;
+    dp.create_project("prj");
+
+    for (auto name : {"a", "b", "c"}) {
+      std::ofstream f(name);
+      f << name;
+    }
+
+    std::stringstream in;
+    in << "# comment\n"
+       << "\n"
+       << "experiment create e1\n"
+       << "file add input a b\n"
+       << "file add input missing\n"          // fails, nothing added
+       << "[\"experiment\", \"abstract\", \"first experiment\"]\n"
+       << "experiment append some notes\n"
+       << "experiment set missing\n"          // fails, no such experiment
+       << "file unlink b\n"
+       << "project abstract 'the project'\n"
+       << "experiment create e2\n"
+       << "file add output c\n"
+       << "nonsense command\n";
+
+    std::vector<srdp::Batch::result_t> results;
+    size_t commits = 0;
+
+    srdp::Batch batch(dp, 2);
+    size_t failed = batch.run(in,
+        [&results](const srdp::Batch::result_t& r) { results.push_back(r); },
+        [&commits]() { commits++; });
+
+    REQUIRE( failed == 3 );
+    REQUIRE( results.size() == 11 );
+    REQUIRE( commits == 6 );
+
+    std::vector<size_t> failed_lines;
+    for (const auto& r : results)
+      if (!r.ok) failed_lines.push_back(r.line);
+    REQUIRE( failed_lines == std::vector<size_t>{5, 8, 13} );
+    REQUIRE( results[1].message.find("added a") != std::string::npos );
+    REQUIRE( results[6].message.rfind("Remove input b (", 0) == 0 );
+
+    // All successful commands are committed
+    auto e1 = dp.open_experiment("e1");
+    REQUIRE( *e1.metadata == "first experiment" );
+    REQUIRE( e1.journal().get().find("some notes") != std::string::npos );
+    REQUIRE( dp.get_file("", "e1").list().size() == 1 );
+    REQUIRE( *dp.open_project().metadata == "the project" );
+
+    auto e2 = dp.open_experiment("e2");
+    REQUIRE( dp.open_experiment().uuid == e2.uuid );
+    REQUIRE( dp.get_file("", "e2").list().size() == 1 );
+  }
+
+  {
+    // Invalid batch sizes are rejected
+    srdp::Srdp dp;
+    REQUIRE_THROWS( srdp::Batch(dp, 0) );
+  }
+
+  fs::current_path(old_cwd);
+  REQUIRE_NOTHROW( fs::remove_all(batch_dir) );
+}
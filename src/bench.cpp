@@ -0,0 +1,310 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <getopt.h>
+
+#include "srdp.h"
+#include "generator.h"
+#include "output.h"
+
+/**
+ * Benchmarks of libsrdp.
+ *
+ * Every benchmark is run a number of times, the timings are written
+ * as JSON Lines to stdout, one record per benchmark. Items is the
+ * number of objects handled per run, e.g. files listed.
+ */
+
+namespace {
+
+  struct options_t {
+    size_t runs = 100;
+    std::string filter;
+    srdp::GeneratorOptions project;
+  };
+
+  // Time f runs times, setup is not timed
+  void measure(srdp::OutputWriter& out, const options_t& opts, const std::string& name,
+      const std::function<void()>& f, const std::function<void()>& setup = nullptr,
+      size_t items = 1, size_t runs = 0){
+
+    if (!opts.filter.empty() && name.find(opts.filter) == std::string::npos)
+      return;
+
+    if (runs == 0) runs = opts.runs;
+
+    std::vector<int64_t> times;
+    times.reserve(runs);
+
+    for (size_t i=0; i < runs; i++) {
+      if (setup) setup();
+
+      const auto start = std::chrono::steady_clock::now();
+      f();
+      const auto end = std::chrono::steady_clock::now();
+
+      times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    std::sort(times.begin(), times.end());
+
+    out.begin_record();
+    out.field("name", name);
+    out.field("version", srdp::version);
+    out.field("runs", int64_t(times.size()));
+    out.field("items", int64_t(items));
+    out.field("min_ns", times.front());
+    out.field("median_ns", times[times.size() / 2]);
+    out.field("mean_ns", std::accumulate(times.begin(), times.end(), int64_t(0)) / int64_t(times.size()));
+    out.field("max_ns", times.back());
+    out.end_record();
+  }
+
+  // Startup of short commands, from a directory deep inside the project
+  void bench_startup(srdp::OutputWriter& out, const options_t& opts){
+    const fs::path top = fs::current_path();
+    const fs::path deep = top / "a/b/c/d/e/f/g/h";
+    fs::create_directories(deep);
+
+    {
+      srdp::Srdp dp;
+      dp.create_project("bench");
+    }
+
+    fs::current_path(deep);
+
+    measure(out, opts, "startup/construct", []() {
+        srdp::Srdp dp;
+      });
+
+    setenv(srdp::Srdp::top_level_dir_env, top.c_str(), 1);
+    measure(out, opts, "startup/construct_env", []() {
+        srdp::Srdp dp;
+      });
+    unsetenv(srdp::Srdp::top_level_dir_env);
+
+    measure(out, opts, "startup/open_project", []() {
+        srdp::Srdp dp;
+        dp.open_project();
+      });
+
+    measure(out, opts, "startup/ignore_rules", []() {
+        srdp::Srdp dp;
+        dp.get_ignore_matcher().is_ignored(std::string_view("a/b/file"), false);
+      });
+
+    fs::current_path(top);
+  }
+
+  size_t count_nodes(const srdp::FileTree& tree){
+    size_t n = 1;
+    for (const auto& child : tree.children)
+      n += count_nodes(child);
+    return n;
+  }
+
+  // Operations on a generated project, see dp-gen
+  void bench_project(srdp::OutputWriter& out, const options_t& opts){
+    srdp::Srdp dp;
+    dp.create_project("generated");
+
+    srdp::Generator gen(dp, opts.project);
+    gen.run();
+
+    if (gen.outputs.empty())
+      throw std::invalid_argument("Generated project has no files");
+
+    // Slow operations over the whole project are run less often
+    const size_t few_runs = std::max<size_t>(1, opts.runs / 10);
+    const std::string last = gen.experiments.back();
+
+    {
+      srdp::File file = dp.get_file("", last);
+      const size_t items = file.list().size();
+
+      measure(out, opts, "file/list", [&]() {
+          file.list();
+        }, nullptr, items);
+    }
+
+    {
+      const std::string id = gen.outputs.back().lexically_relative(dp.get_top_level_dir()).string();
+      srdp::File file = dp.load_file("", last, id);
+      const size_t items = count_nodes(file.track(0, int(opts.project.depth) + 1));
+
+      measure(out, opts, "file/track", [&]() {
+          file.track(0, int(opts.project.depth) + 1);
+        }, nullptr, items);
+    }
+
+    measure(out, opts, "srdp/verify", [&]() {
+        dp.verify();
+      }, nullptr, gen.files, few_runs);
+
+    {
+      const size_t items = dp.get_file_list(true, 0, false).size();
+
+      measure(out, opts, "status/get_file_list", [&]() {
+          dp.get_file_list(true, 0, false);
+        }, nullptr, items, few_runs);
+
+      // Index is written by the first call
+      dp.get_file_list(true, 0, true);
+      measure(out, opts, "status/get_file_list_index", [&]() {
+          dp.get_file_list(true, 0, true);
+        }, nullptr, items, few_runs);
+    }
+
+    {
+      std::vector<std::string> paths;
+      for (const auto& path : gen.outputs)
+        paths.push_back(path.lexically_relative(dp.get_top_level_dir()).string());
+
+      // Rules of a large project
+      srdp::IgnoreFile rules;
+      for (int i=0; i < 50; i++) {
+        rules.add_pattern("*.tmp" + std::to_string(i));
+        rules.add_pattern("d0_" + std::to_string(i) + "/**/cache/");
+        rules.add_pattern("/build" + std::to_string(i) + "/");
+      }
+      rules.add_pattern("*.log");
+      rules.add_pattern("!keep.log");
+
+      measure(out, opts, "ignore/match", [&]() {
+          for (const auto& path : paths)
+            rules.match(path, false);
+        }, nullptr, paths.size());
+
+      const auto& tree = dp.get_ignore_matcher();
+      measure(out, opts, "ignore/is_ignored", [&]() {
+          for (const auto& path : paths)
+            tree.is_ignored(std::string_view(path), false);
+        }, nullptr, paths.size());
+    }
+
+    // Writes last, the fake hashes of file/create are not in the store
+    const srdp::Experiment bench = dp.create_experiment("bench");
+
+    {
+      srdp::File file = dp.get_file("", "bench");
+      uint64_t counter = 0;
+
+      measure(out, opts, "file/create", [&]() {
+          file.create();
+        }, [&]() {
+          scas::Hash hash;
+          hash.update("bench " + std::to_string(counter++));
+          file.hash = hash.get_hash_binary();
+          file.size = 1;
+          file.role = srdp::File::role_t::output;
+          file.path = "bench/" + std::to_string(counter);
+        });
+    }
+
+    {
+      fs::path name;
+      measure(out, opts, "srdp/add_file", [&]() {
+          dp.add_file(bench, name, srdp::File::role_t::output);
+        }, [&]() {
+          name = gen.write_file();
+        });
+    }
+  }
+
+  void print_help(){
+    std::cout << "Usage: srdp_bench [options]\n\n";
+    std::cout << "Run the benchmarks in a scratch project in the current directory.\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --help, -h:          Show help.\n";
+    std::cout << "  --runs, -n <count>:  Runs per benchmark (default 100).\n";
+    std::cout << "  --filter, -f <str>:  Only run benchmarks whose name contains str.\n";
+    std::cout << "\nGenerated project (see dp-gen):\n";
+    std::cout << "  --experiments, -e <count>:  Number of experiments (default 10).\n";
+    std::cout << "  --files, -F <count>:        Output files per experiment (default 100).\n";
+    std::cout << "  --depth, -d <count>:        Lineage depth (default 3).\n";
+    std::cout << "  --fan-in, -i <count>:       Inputs per experiment (default 2).\n";
+  }
+}
+
+int main(int argc, char* argv[]){
+  const struct option long_options[] = {
+    {"help", no_argument, 0, 'h'},
+    {"runs", required_argument, 0, 'n'},
+    {"filter", required_argument, 0, 'f'},
+    {"experiments", required_argument, 0, 'e'},
+    {"files", required_argument, 0, 'F'},
+    {"depth", required_argument, 0, 'd'},
+    {"fan-in", required_argument, 0, 'i'},
+    {0, 0, 0, 0}
+  };
+
+  options_t opts;
+  int opt = 0;
+
+  try {
+    while ((opt = getopt_long(argc, argv, "hn:f:e:F:d:i:", long_options, 0)) != -1) {
+      switch (opt) {
+        case 'h':
+          print_help();
+          return EXIT_SUCCESS;
+        case 'n':
+          opts.runs = std::stoul(optarg);
+          break;
+        case 'f':
+          opts.filter = optarg;
+          break;
+        case 'e':
+          opts.project.experiments = std::stoul(optarg);
+          break;
+        case 'F':
+          opts.project.files = std::stoul(optarg);
+          break;
+        case 'd':
+          opts.project.depth = std::stoul(optarg);
+          break;
+        case 'i':
+          opts.project.fan_in = std::stoul(optarg);
+          break;
+        default:
+          throw std::invalid_argument("Unknown option");
+      }
+    }
+
+    if (opts.runs == 0)
+      throw std::invalid_argument("Number of runs must be at least 1");
+
+    const fs::path old_cwd = fs::current_path();
+    const fs::path scratch = fs::absolute("srdp_bench.tmp");
+    fs::remove_all(scratch);
+    fs::create_directory(scratch);
+    fs::current_path(scratch);
+
+    try {
+      srdp::Srdp::init("./");
+
+      srdp::OutputWriter out(srdp::OutputWriter::format_t::jsonl);
+      bench_startup(out, opts);
+      bench_project(out, opts);
+      out.flush();
+    } catch (...) {
+      fs::current_path(old_cwd);
+      fs::remove_all(scratch);
+      throw;
+    }
+
+    fs::current_path(old_cwd);
+    fs::remove_all(scratch);
+  } catch (std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
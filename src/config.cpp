@@ -21,48 +21,74 @@ namespace srdp {
     )");
   }
 
-  uuids::uuid Config::get_uuid(const std::string& key){
-    uuids::uuid uuid;
-    auto res = db->query("SELECT value_blob FROM config WHERE name = ?;",
-               Sql::vec_sql_t{key},
-               Sql::vec_sql_t{bin_to_blob(uuids::random_generator()())});
+  void Config::refresh(){
+    // Changes only if another connection has committed
+    auto version = db->query("PRAGMA data_version;", Sql::vec_sql_t(0), Sql::vec_sql_t{int64_t(0)});
+    const int64_t current = (version && (*version)[0]) ? std::get<int64_t>(*(*version)[0]) : -1;
+    while (version) version = db->next_row();
+
+    if (current == data_version && current != -1) return;
+
+    snapshot.clear();
+
+    auto row = db->query("SELECT name, value_blob, value_string FROM config;",
+        Sql::vec_sql_t(0),
+        Sql::vec_sql_t{std::string(), Sql::blob_t(), std::string()});
 
-    if (res){
-      auto row = *res;
-      if (!row[0])
-        return uuid;
+    while (row) {
+      const auto& r = *row;
+      value_t value;
 
-      uuid =  blob_to_bin<uuids::uuid>(std::get<Sql::blob_t>(*row[0]));
+      if (r[1]) {
+        const auto& blob = std::get<Sql::blob_t>(*r[1]);
+        if (blob.size() == uuids::uuid::static_size())
+          value.uuid = blob_to_bin<uuids::uuid>(blob);
+      }
+      if (r[2])
+        value.str = std::get<std::string>(*r[2]);
+
+      snapshot[std::get<std::string>(*r[0])] = std::move(value);
+      row = db->next_row();
     }
 
-    return uuid;
+    data_version = current;
+  }
+
+  uuids::uuid Config::get_uuid(const std::string& key){
+    refresh();
+
+    auto it = snapshot.find(key);
+    if (it == snapshot.end() || !it->second.uuid)
+      return uuids::nil_uuid();
+
+    return *it->second.uuid;
   }
 
   void Config::set_uuid(const std::string& key, const uuids::uuid& uuid){
     db->query("INSERT OR REPLACE INTO config (name, value_blob, value_string) VALUES (?, ?, NULL);",
               Sql::vec_sql_t{key, bin_to_blob(uuid)});
+
+    // Own changes do not change the data version
+    if (data_version != -1)
+      snapshot[key] = value_t{uuid, std::nullopt};
   }
 
   std::string Config::get_string(const std::string& key){
-    std::string str;
-    auto res = db->query("SELECT value_string FROM config WHERE name = ?;",
-               Sql::vec_sql_t{key},
-               Sql::vec_sql_t{key});
+    refresh();
 
-    if (res){
-      auto row = *res;
-      if (!row[0]) return str;
-      if (!std::holds_alternative<std::string>(*row[0])) return str;
+    auto it = snapshot.find(key);
+    if (it == snapshot.end() || !it->second.str)
+      return std::string();
 
-      str =  std::get<std::string>(*row[0]);
-    }
-
-    return str;
+    return *it->second.str;
   }
 
   void Config::set_string(const std::string& key, const std::string& value){
     db->query("INSERT OR REPLACE INTO config (name, value_string, value_blob) VALUES (?, ?, NULL);",
               Sql::vec_sql_t{key, value});
+
+    if (data_version != -1)
+      snapshot[key] = value_t{std::nullopt, value};
   }
 
 }
@@ -6,12 +6,30 @@
 #define SRDP_CONFIG_H
 
 #include <memory>
+#include <unordered_map>
 #include "sql.h"
 
 namespace srdp {
+  /**
+   * Key/value settings of a project.
+   *
+   * The table is held as an in-memory snapshot, which is written
+   * through on changes. The snapshot is reloaded when another connection
+   * has modified the database (PRAGMA data_version). Changes made through
+   * another Config object on the same connection are not seen.
+   */
   class Config {
     private:
+      struct value_t {
+        std::optional<uuids::uuid> uuid;
+        std::optional<std::string> str;
+      };
+
       std::shared_ptr<Sql> db;
+      std::unordered_map<std::string, value_t> snapshot;
+      int64_t data_version = -1; // of the snapshot, -1 = not loaded
+
+      void refresh();
 
     public:
       Config(){};
@@ -19,6 +37,12 @@ namespace srdp {
 
       static void create_table(Sql& db);
 
+      // Force a reload, e.g. after a rolled back transaction
+      void invalidate() { data_version = -1; }
+
+      // Changes whenever another connection has committed
+      int64_t get_data_version() { refresh(); return data_version; }
+
       uuids::uuid get_uuid(const std::string& key);
       void set_uuid(const std::string& key, const uuids::uuid& uuid);
 
@@ -38,6 +62,9 @@ namespace srdp {
 
       std::string get_store_path() { return get_string("store_path"); }
       void set_store_path(const std::string& path) { set_string("store_path", path); }
+
+      bool get_use_gitignore() { return get_string("use_gitignore") == "yes"; }
+      void set_use_gitignore(bool use) { set_string("use_gitignore", use ? "yes" : "no"); }
   };
 }
 
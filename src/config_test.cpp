@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include <iostream>
+#include <vector>
 #include <catch2/catch_test_macros.hpp>
 
 #include "config.h"
@@ -27,3 +28,32 @@ TEST_CASE("Config Interface", "[config]"){
 
   std::filesystem::remove(db_path);
 }
+
+TEST_CASE("Config snapshot", "[config]"){
+  auto db = std::make_shared<srdp::Sql>(db_path);
+  REQUIRE_NOTHROW( srdp::Config::create_table(*db) );
+
+  srdp::Config config(db);
+  REQUIRE_NOTHROW( config.set_string("owner", "a") );
+  REQUIRE( config.get_string("owner") == "a" );
+
+  // Unchanged DB: only the data version is queried
+  std::vector<std::string> statements;
+  srdp::Sql::set_hook([&statements](const std::string& sql) { statements.push_back(sql); });
+  REQUIRE( config.get_string("owner") == "a" );
+  srdp::Sql::set_hook(nullptr);
+  REQUIRE( statements.size() == 1 );
+  REQUIRE( statements[0].find("data_version") != std::string::npos );
+
+  {
+    // Change through a second connection
+    auto db2 = std::make_shared<srdp::Sql>(db_path);
+    srdp::Config config2(db2);
+    REQUIRE( config2.get_string("owner") == "a" );
+    REQUIRE_NOTHROW( config2.set_string("owner", "b") );
+  }
+
+  REQUIRE( config.get_string("owner") == "b" );
+
+  std::filesystem::remove(db_path);
+}
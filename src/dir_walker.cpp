@@ -0,0 +1,167 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include "dir_walker.h"
+#include "sys_calls.h"
+#include "timings.h"
+
+namespace srdp {
+
+  // Layout of the records returned by getdents64
+  struct linux_dirent64 {
+    ino64_t d_ino;
+    off64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+  };
+
+  DirWalker::DirWalker(unsigned threads) : nthreads(threads) {
+    if (nthreads == 0)
+      nthreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  void DirWalker::read_dir(int fd, const fs::path& dir, std::vector<Entry>& entries){
+    Timings::Span span("dir.read");
+    alignas(linux_dirent64) char buffer[64 * 1024];
+
+    while (true) {
+      const long nread = sys::getdents64(fd, buffer, sizeof(buffer));
+
+      if (nread == -1)
+        throw fs::filesystem_error("Can not read directory", dir, std::error_code(errno, std::system_category()));
+
+      if (nread == 0) break;
+
+      for (long pos = 0; pos < nread;) {
+        auto d = reinterpret_cast<linux_dirent64*>(buffer + pos);
+        pos += d->d_reclen;
+
+        if (std::strcmp(d->d_name, ".") == 0 || std::strcmp(d->d_name, "..") == 0)
+          continue;
+
+        entries.push_back(Entry{d->d_name, d->d_type});
+      }
+    }
+  }
+
+  void DirWalker::walk(const fs::path& root, const classifier_t& classify, const prefilter_t& prefilter){
+    Timings::Span span("dir.walk");
+    Timings::node_t* const timings = Timings::current();
+
+    std::vector<std::unique_ptr<queue_t>> queues;
+    for (unsigned i=0; i < nthreads; i++)
+      queues.push_back(std::make_unique<queue_t>());
+
+    // Number of directories queued or in progress
+    std::atomic<size_t> pending(1);
+    std::atomic<bool> abort(false);
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    queues[0]->dirs.push_back(root);
+
+    auto pop = [&](unsigned worker, fs::path& dir) -> bool {
+      // Own queue: depth first
+      {
+        auto& q = *queues[worker];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.dirs.empty()) {
+          dir = std::move(q.dirs.back());
+          q.dirs.pop_back();
+          return true;
+        }
+      }
+
+      // Steal the oldest (largest) subtree from another thread
+      for (unsigned i=1; i < nthreads; i++) {
+        auto& q = *queues[(worker + i) % nthreads];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.dirs.empty()) {
+          dir = std::move(q.dirs.front());
+          q.dirs.pop_front();
+          return true;
+        }
+      }
+
+      return false;
+    };
+
+    auto worker = [&](unsigned id) {
+      Timings::Adopt adopt(timings);
+      std::vector<Entry> entries;
+      fs::path dir;
+
+      try {
+        while (!abort) {
+          if (!pop(id, dir)) {
+            if (pending == 0) break;
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            continue;
+          }
+
+          std::vector<fs::path> subdirs;
+
+          if (!prefilter || !prefilter(id, dir, subdirs)) {
+            const int fd = sys::openat(AT_FDCWD, dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (fd == -1)
+              throw fs::filesystem_error("Can not open directory", dir, std::error_code(errno, std::system_category()));
+
+            try {
+              struct stat dir_stat;
+              if (sys::fstat(fd, &dir_stat) != 0)
+                throw fs::filesystem_error("Can not stat directory", dir, std::error_code(errno, std::system_category()));
+
+              entries.clear();
+              subdirs.clear();
+              read_dir(fd, dir, entries);
+              subdirs = classify(id, fd, dir, dir_stat, entries);
+            } catch (...) {
+              close(fd);
+              throw;
+            }
+            close(fd);
+          }
+
+          if (!subdirs.empty()) {
+            pending += subdirs.size();
+
+            auto& q = *queues[id];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            for (auto& d : subdirs)
+              q.dirs.push_back(std::move(d));
+          }
+
+          pending--;
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+        abort = true;
+      }
+    };
+
+    if (nthreads == 1) {
+      worker(0);
+    } else {
+      std::vector<std::thread> threads;
+      for (unsigned i=0; i < nthreads; i++)
+        threads.emplace_back(worker, i);
+
+      for (auto& t : threads)
+        t.join();
+    }
+
+    if (error)
+      std::rethrow_exception(error);
+  }
+}
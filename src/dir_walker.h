@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_DIR_WALKER_H
+#define SRDP_DIR_WALKER_H
+
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+namespace srdp {
+
+  namespace fs = std::filesystem;
+
+  /**
+   * Parallel directory walker.
+   *
+   * Directories are read with getdents64, which provides the entry type
+   * without an extra stat. Each thread works depth first on its own deque
+   * and steals from the other threads' deques when it runs out of work.
+   */
+  class DirWalker {
+    public:
+      struct Entry {
+        std::string name;
+        unsigned char type; // DT_* value, DT_UNKNOWN if not provided by the file system
+      };
+
+      /* Classify the entries of one directory.
+       *
+       * Called concurrently from the worker threads. worker is the index
+       * of the calling thread, dirfd an open descriptor of dir, and
+       * dir_stat its stat taken before the entries were read.
+       * Returns the directories to descend into.
+       */
+      using classifier_t = std::function<std::vector<fs::path>(
+          unsigned worker, int dirfd, const fs::path& dir, const struct stat& dir_stat, std::vector<Entry>& entries)>;
+
+      /* Called before a directory is read.
+       *
+       * Returns true if the directory has been handled without reading it
+       * (e.g. from a cache), in which case subdirs holds the directories
+       * to descend into.
+       */
+      using prefilter_t = std::function<bool(unsigned worker, const fs::path& dir, std::vector<fs::path>& subdirs)>;
+
+    private:
+      struct queue_t {
+        std::mutex mutex;
+        std::deque<fs::path> dirs;
+      };
+
+      unsigned nthreads;
+
+      static void read_dir(int fd, const fs::path& dir, std::vector<Entry>& entries);
+
+    public:
+      // threads = 0 selects the number of hardware threads
+      DirWalker(unsigned threads = 0);
+
+      unsigned get_threads() const { return nthreads; }
+
+      /**
+       * Walk the tree below root.
+       * The first exception thrown by a classifier is re-thrown.
+       */
+      void walk(const fs::path& root, const classifier_t& classify, const prefilter_t& prefilter = nullptr);
+  };
+}
+
+#endif /* SRDP_DIR_WALKER_H */
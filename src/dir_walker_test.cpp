@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <dirent.h>
+#include <catch2/catch_test_macros.hpp>
+
+#include "dir_walker.h"
+
+const std::filesystem::path walk_dir("test_walk");
+
+TEST_CASE("Parallel directory walk", "[dir_walker]") {
+  std::filesystem::create_directories(walk_dir / "skip");
+
+  // 10 x 10 directories with one file each
+  for (int i=0; i < 10; i++) {
+    for (int j=0; j < 10; j++) {
+      auto dir = walk_dir / std::to_string(i) / std::to_string(j);
+      std::filesystem::create_directories(dir);
+      std::ofstream(dir / "file") << "data";
+    }
+  }
+  std::ofstream(walk_dir / "skip" / "file") << "data";
+
+  for (unsigned threads : {1u, 4u}) {
+    srdp::DirWalker walker(threads);
+    REQUIRE( walker.get_threads() == threads );
+
+    std::mutex mutex;
+    std::set<std::filesystem::path> files;
+    bool args_valid = true;
+
+    REQUIRE_NOTHROW( walker.walk(walk_dir, [&](unsigned worker, int dirfd, const std::filesystem::path& dir, const struct stat&, std::vector<srdp::DirWalker::Entry>& entries) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (worker >= threads || dirfd < 0) args_valid = false;
+
+      std::vector<std::filesystem::path> subdirs;
+      for (auto& e : entries) {
+        if (e.type == DT_DIR && e.name != "skip")
+          subdirs.push_back(dir / e.name);
+        else if (e.type == DT_REG)
+          files.insert(dir / e.name);
+      }
+      return subdirs;
+    }) );
+
+    REQUIRE( args_valid );
+    REQUIRE( files.size() == 100 );
+    REQUIRE( files.count(walk_dir / "3" / "7" / "file") == 1 );
+    REQUIRE( files.count(walk_dir / "skip" / "file") == 0 );
+  }
+
+  // Errors are passed on
+  srdp::DirWalker walker(2);
+  REQUIRE_THROWS( walker.walk(walk_dir / "does_not_exist", [](unsigned, int, const std::filesystem::path&, const struct stat&, std::vector<srdp::DirWalker::Entry>&) {
+    return std::vector<std::filesystem::path>();
+  }) );
+
+  REQUIRE_THROWS( walker.walk(walk_dir, [](unsigned, int, const std::filesystem::path&, const struct stat&, std::vector<srdp::DirWalker::Entry>&) -> std::vector<std::filesystem::path> {
+    throw std::runtime_error("classifier failed");
+  }) );
+
+  std::filesystem::remove_all(walk_dir);
+}
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "experiment.h"
+#include "journal.h"
 
 #include <iostream>
 
@@ -18,7 +19,6 @@ namespace srdp {
           metadata TEXT,
           owner TEXT,
           ctime INTEGER,
-          journal TEXT,
           locked BOOLEAN DEFAULT FALSE,
           UNIQUE(project, name),
           FOREIGN KEY(project) REFERENCES projects(uuid)
@@ -26,7 +26,10 @@ namespace srdp {
 
         CREATE INDEX IF NOT EXISTS idx_project_uuid ON experiments (project);
         CREATE INDEX IF NOT EXISTS idx_experiment_name ON experiments (name);
+        CREATE INDEX IF NOT EXISTS idx_experiment_ctime ON experiments (project, IFNULL(ctime, 0));
       )");
+
+    Journal::create_table(db);
 //FOREIGN KEY (uuid) REFERENCES file_map(uuid)
   }
 
@@ -171,6 +174,7 @@ namespace srdp {
   void Experiment::remove(){
     db->query("DELETE FROM experiments WHERE uuid = ?",
              Sql::vec_sql_t{bin_to_blob(uuid)});
+    journal().clear();
 
     uuid = uuids::random_generator()();
     name = std::string();
@@ -181,13 +185,32 @@ namespace srdp {
   }
 
   std::vector<Experiment> Experiment::list(){
-    auto res = db->query(R"(
+    return list(PageOptions());
+  }
+
+  std::vector<Experiment> Experiment::list(const PageOptions& page){
+    std::string sql = R"(
       SELECT uuid, project, name, metadata, owner, ctime, locked
       FROM experiments
-      WHERE project = ?
-      ORDER BY ctime
-      )",
-             Sql::vec_sql_t{bin_to_blob(project)},
+      WHERE project = ?)";
+    Sql::vec_sql_t bindings{bin_to_blob(project)};
+
+    // Ties keep the creation order, the cursor holds the uuid of its row
+    const std::string tie_value = "IFNULL((SELECT rowid FROM experiments WHERE uuid = ?), 0)";
+
+    switch (page.sort) {
+      case PageOptions::sort_t::none:
+      case PageOptions::sort_t::ctime:
+        page.apply(sql, bindings, "IFNULL(ctime, 0)", PageOptions::key_t::integer, "rowid", true, tie_value);
+        break;
+      case PageOptions::sort_t::name:
+        page.apply(sql, bindings, "name", PageOptions::key_t::text, "rowid", true, tie_value);
+        break;
+      default:
+        throw std::invalid_argument("Experiments can not be sorted by " + PageOptions::sort_to_string(page.sort));
+    }
+
+    auto res = db->query(sql, bindings,
              Sql::vec_sql_t{Sql::blob_t(), // uuid
                             Sql::blob_t(), // project
                             std::string(), // name
@@ -216,27 +239,26 @@ namespace srdp {
     return experiment_list;
   }
 
-  std::string Experiment::get_journal(){
-    auto res = db->query("SELECT journal FROM experiments WHERE uuid = ?;",
-             Sql::vec_sql_t{bin_to_blob(uuid)},
-             Sql::vec_sql_t{std::string()});
-
-    if (!res)
-      throw std::runtime_error("Invalid project UUID");
+  std::string Experiment::cursor(PageOptions::sort_t sort) const {
+    if (sort == PageOptions::sort_t::name)
+      return PageOptions::make_cursor(name, bin_to_blob(uuid));
+    else
+      return PageOptions::make_cursor(std::to_string(ctime.value_or(0)), bin_to_blob(uuid));
+  }
 
-    auto row = *res;
+  Journal Experiment::journal(){
+    return Journal(db, uuid);
+  }
 
-    if (row[0]) return std::get<std::string>(*row[0]);
-    else return "";
+  std::string Experiment::get_journal(){
+    return journal().get();
   }
 
   void Experiment::set_journal(const std::string& text){
-    db->query("UPDATE experiments SET journal = ? WHERE uuid = ?;",
-             Sql::vec_sql_t{text, bin_to_blob(uuid)});
+    journal().set(text);
   }
 
   void Experiment::append_journal(const std::string& text){
-    db->query("UPDATE experiments SET journal = concat(journal, ?) WHERE uuid = ?;",
-             Sql::vec_sql_t{text, bin_to_blob(uuid)});
+    journal().append(text);
   }
 }
@@ -14,10 +14,10 @@ namespace srdp {
       std::shared_ptr<Sql> db;
 
     public:
-      uuids::uuid project;
+      uuids::uuid project = uuids::nil_uuid();
 
       // Accessible properties
-      uuids::uuid uuid;
+      uuids::uuid uuid = uuids::nil_uuid();
       std::string name;
       std::optional<std::string> metadata;
       std::optional<std::string> owner;
@@ -42,7 +42,13 @@ namespace srdp {
 
       void update();
       std::vector<Experiment> list();
+      // Sorted by ctime (default) or name
+      std::vector<Experiment> list(const PageOptions& page);
+      // Cursor selecting the experiments after this one
+      std::string cursor(PageOptions::sort_t sort) const;
 
+      // Journal entries, appends do not rewrite the journal
+      Journal journal();
       std::string get_journal();
       void set_journal(const std::string& text);
       void append_journal(const std::string& text);
@@ -39,6 +39,9 @@ namespace srdp {
 
         CREATE INDEX IF NOT EXISTS idx_experiment_uuid ON file_map (uuid);
         CREATE INDEX IF NOT EXISTS idx_file_hash ON file_map (hash);
+        CREATE INDEX IF NOT EXISTS idx_file_map_role_page ON file_map (uuid, role, hash);
+        CREATE INDEX IF NOT EXISTS idx_file_map_path_page ON file_map (uuid, IFNULL(path, ''), hash);
+        CREATE INDEX IF NOT EXISTS idx_file_map_path ON file_map (path, uuid);
 
         CREATE TABLE IF NOT EXISTS file_roles (
           id INTEGER NOT NULL PRIMARY KEY,
@@ -375,43 +378,120 @@ namespace srdp {
   }
 
   std::vector<File> File::list(std::optional<role_t> role){
-    std::optional<Sql::vec_sql_opt_t> res;
+    return list(PageOptions(), role);
+  }
+
+  void File::scan(const PageOptions& page, std::optional<role_t> role, const std::function<void(const view_t& row)>& visitor){
+    std::string sql = R"(
+        SELECT
+          files.hash, files.size, files.name, files.creator, files.owner, files.ctime, files.metadata, file_map.path, file_map.role
+        FROM file_map
+        JOIN files ON file_map.hash = files.hash
+        WHERE file_map.uuid = ?)";
+    Sql::vec_sql_t bindings{bin_to_blob(experiment)};
+
     if (role) {
-      res = db->query(R"(
-          SELECT hash, path FROM file_map
-          WHERE uuid = ? AND role = ?
-          ORDER BY role;
-        )",
-         Sql::vec_sql_t{bin_to_blob(experiment), int(*role)},
-         Sql::vec_sql_t{bin_to_blob(scas::Hash::hash_t()), ""});
-    } else {
-      res = db->query(R"(
-          SELECT hash, path FROM file_map
-          WHERE uuid = ?
-          ORDER BY role;
-        )",
-         Sql::vec_sql_t{bin_to_blob(experiment)},
-         Sql::vec_sql_t{bin_to_blob(scas::Hash::hash_t()), ""});
+      sql += " AND file_map.role = ?";
+      bindings.push_back(int(*role));
+    }
+
+    switch (page.sort) {
+      case PageOptions::sort_t::none:
+      case PageOptions::sort_t::role:
+        page.apply(sql, bindings, "file_map.role", PageOptions::key_t::integer, "file_map.hash", true);
+        break;
+      case PageOptions::sort_t::path:
+        page.apply(sql, bindings, "IFNULL(file_map.path, '')", PageOptions::key_t::text, "file_map.hash", true);
+        break;
+      case PageOptions::sort_t::hash:
+        page.apply(sql, bindings, "file_map.hash", PageOptions::key_t::blob, "file_map.hash", true);
+        break;
+      default:
+        throw std::invalid_argument("Files can not be sorted by " + PageOptions::sort_to_string(page.sort));
     }
 
-    std::vector<std::tuple<scas::Hash::hash_t, std::optional<std::string>>> hash_list;
+    db->for_each_row(sql, bindings, [&visitor](Sql& row) {
+      view_t v;
+      v.hash = *row.get_column_view(0);
+      v.size = *row.get_column_int64(1);
+      v.original_name = row.get_column_view(2);
+      v.creator_uuid = row.get_column_view(3);
+      v.owner = row.get_column_view(4);
+      v.ctime = row.get_column_int64(5);
+      v.metadata = row.get_column_view(6);
+      v.path = row.get_column_view(7);
+      v.role = role_t(*row.get_column_int(8));
+
+      visitor(v);
+    });
+  }
+
+  std::vector<File> File::list(const PageOptions& page, std::optional<role_t> role){
     std::vector<File> files;
 
-    while (res){
-      auto row = *res;
-      hash_list.push_back(std::tuple<scas::Hash::hash_t, std::optional<std::string>>(
-            blob_to_bin<scas::Hash::hash_t>(std::get<Sql::blob_t>(*row[0])),
-            Sql::sql_repack_optional<std::string>(row[1])));
-      res = db->next_row();
+    auto to_string = [](const std::optional<std::string_view>& v) {
+      return v ? std::optional<std::string>(*v) : std::optional<std::string>();
+    };
+
+    scan(page, role, [&](const view_t& row) {
+      File f(db, experiment);
+      f.hash = blob_to_bin<scas::Hash::hash_t>(Sql::blob_t(row.hash.begin(), row.hash.end()));
+      f.size = row.size;
+      f.original_name = to_string(row.original_name);
+      if (row.creator_uuid)
+        f.creator_uuid = blob_to_bin<uuids::uuid>(Sql::blob_t(row.creator_uuid->begin(), row.creator_uuid->end()));
+      f.owner = to_string(row.owner);
+      f.ctime = row.ctime;
+      f.metadata = to_string(row.metadata);
+      f.path = to_string(row.path);
+      f.role = row.role;
+      files.push_back(f);
+    });
+
+    return files;
+  }
+
+  std::string File::cursor(PageOptions::sort_t sort) const {
+    switch (sort) {
+      case PageOptions::sort_t::path:
+        return PageOptions::make_cursor(path.value_or(""), bin_to_blob(hash));
+      case PageOptions::sort_t::hash:
+        return PageOptions::make_cursor(bin_to_blob(hash), bin_to_blob(hash));
+      default:
+        return PageOptions::make_cursor(std::to_string(int(role.value_or(role_t::none))), bin_to_blob(hash));
     }
+  }
 
+  std::string File::cursor(const view_t& row, PageOptions::sort_t sort){
+    const Sql::blob_t hash(row.hash.begin(), row.hash.end());
 
-    for (auto hashi : hash_list) {
-      files.push_back(File(db, experiment, std::get<0>(hashi)));
-      files.back().path = std::get<1>(hashi);
+    switch (sort) {
+      case PageOptions::sort_t::path:
+        return PageOptions::make_cursor(std::string(row.path.value_or("")), hash);
+      case PageOptions::sort_t::hash:
+        return PageOptions::make_cursor(hash, hash);
+      default:
+        return PageOptions::make_cursor(std::to_string(int(row.role)), hash);
     }
+  }
 
-    return files;
+  std::vector<std::string> File::list_paths(){
+    auto res = db->query(R"(
+        SELECT path FROM file_map
+        WHERE uuid = ? AND path IS NOT NULL;
+      )",
+       Sql::vec_sql_t{bin_to_blob(experiment)},
+       Sql::vec_sql_t{std::string()});
+
+    std::vector<std::string> paths;
+
+    while (res){
+      auto row = *res;
+      if (row[0]) paths.push_back(std::get<std::string>(*row[0]));
+      res = db->next_row();
+    }
+
+    return paths;
   }
 
   FileTree File::track(int depth, int max_depth){
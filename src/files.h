@@ -33,7 +33,7 @@ namespace srdp {
       static std::string role_to_string(role_t role);
       static role_t string_to_role(const std::string& role);
 
-      uuids::uuid experiment;
+      uuids::uuid experiment = uuids::nil_uuid();
 
       // Accessible properties, can be updated
       scas::Hash::hash_t hash;
@@ -92,6 +92,49 @@ namespace srdp {
        */
       std::vector<File> list(std::optional<role_t> role = std::optional<role_t>());
 
+      /**
+       * List one page of the files connected to experiment.
+       * Sorted by role (default), path, or hash.
+       */
+      std::vector<File> list(const PageOptions& page, std::optional<role_t> role = std::optional<role_t>());
+
+      /**
+       * Cursor selecting the files after this one.
+       */
+      std::string cursor(PageOptions::sort_t sort) const;
+
+      /**
+       * Row of a file listing without copies.
+       * The views are only valid inside the visitor.
+       */
+      struct view_t {
+        std::string_view hash;                        // raw hash bytes
+        int64_t size;
+        std::optional<std::string_view> original_name;
+        std::optional<std::string_view> creator_uuid; // raw uuid bytes
+        std::optional<std::string_view> owner;
+        std::optional<int64_t> ctime;
+        std::optional<std::string_view> metadata;
+        std::optional<std::string_view> path;
+        role_t role;
+      };
+
+      /**
+       * Stream one page of the files connected to experiment,
+       * same order as list(). The visitor must not use the DB.
+       */
+      void scan(const PageOptions& page, std::optional<role_t> role, const std::function<void(const view_t& row)>& visitor);
+
+      /**
+       * Cursor selecting the files after a streamed row.
+       */
+      static std::string cursor(const view_t& row, PageOptions::sort_t sort);
+
+      /**
+       * List paths of all files connected to experiment.
+       */
+      std::vector<std::string> list_paths();
+
       /**
        * Track files heritage
        */
@@ -119,6 +119,11 @@ SCENARIO("Files in DB","[files]") {
         // // FIXME order is not guaranteed
         CHECK( list[0].hash == file.hash );
         CHECK( list[1].hash == file2.hash );
+
+        // Only files with a path are listed
+        auto paths = file.list_paths();
+        REQUIRE( paths.size() == 1 );
+        REQUIRE( paths[0] == path );
       }
     }
   }
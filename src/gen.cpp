@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdlib>
+#include <iostream>
+#include <getopt.h>
+
+#include "generator.h"
+
+/**
+ * dp-gen: create a synthetic project for benchmarks.
+ */
+
+namespace {
+
+  void print_help(){
+    std::cout << "Usage: dp-gen [options] <dir>\n\n";
+    std::cout << "Create a new project with generated experiments and files in dir.\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --help, -h:                 Show help.\n";
+    std::cout << "  --project, -p <name>:       Name of the project (default generated).\n";
+    std::cout << "  --experiments, -e <count>:  Number of experiments (default 10).\n";
+    std::cout << "  --files, -n <count>:        Output files per experiment (default 100).\n";
+    std::cout << "  --depth, -d <count>:        Lineage depth, experiments are split into\n";
+    std::cout << "                              that many generations (default 3).\n";
+    std::cout << "  --fan-in, -i <count>:       Inputs per experiment from the previous\n";
+    std::cout << "                              generation (default 2).\n";
+    std::cout << "  --min-size, -s <bytes>:     Minimum file size (default 16).\n";
+    std::cout << "  --max-size, -S <bytes>:     Maximum file size (default 4096).\n";
+    std::cout << "  --dir-depth, -D <count>:    Depth of the directory tree (default 2).\n";
+    std::cout << "  --dir-width, -w <count>:    Sub directories per directory (default 4).\n";
+    std::cout << "  --untracked, -u <count>:    Files not added to any experiment (default 0).\n";
+    std::cout << "  --seed, -r <number>:        Seed of the random generator (default 1).\n";
+  }
+}
+
+int main(int argc, char* argv[]){
+  const struct option long_options[] = {
+    {"help", no_argument, 0, 'h'},
+    {"project", required_argument, 0, 'p'},
+    {"experiments", required_argument, 0, 'e'},
+    {"files", required_argument, 0, 'n'},
+    {"depth", required_argument, 0, 'd'},
+    {"fan-in", required_argument, 0, 'i'},
+    {"min-size", required_argument, 0, 's'},
+    {"max-size", required_argument, 0, 'S'},
+    {"dir-depth", required_argument, 0, 'D'},
+    {"dir-width", required_argument, 0, 'w'},
+    {"untracked", required_argument, 0, 'u'},
+    {"seed", required_argument, 0, 'r'},
+    {0, 0, 0, 0}
+  };
+
+  srdp::GeneratorOptions opts;
+  std::string project = "generated";
+  int opt = 0;
+
+  try {
+    while ((opt = getopt_long(argc, argv, "hp:e:n:d:i:s:S:D:w:u:r:", long_options, 0)) != -1) {
+      switch (opt) {
+        case 'h':
+          print_help();
+          return EXIT_SUCCESS;
+        case 'p':
+          project = optarg;
+          break;
+        case 'e':
+          opts.experiments = std::stoul(optarg);
+          break;
+        case 'n':
+          opts.files = std::stoul(optarg);
+          break;
+        case 'd':
+          opts.depth = std::stoul(optarg);
+          break;
+        case 'i':
+          opts.fan_in = std::stoul(optarg);
+          break;
+        case 's':
+          opts.min_size = std::stoul(optarg);
+          break;
+        case 'S':
+          opts.max_size = std::stoul(optarg);
+          break;
+        case 'D':
+          opts.dir_depth = std::stoul(optarg);
+          break;
+        case 'w':
+          opts.dir_width = std::stoul(optarg);
+          break;
+        case 'u':
+          opts.untracked = std::stoul(optarg);
+          break;
+        case 'r':
+          opts.seed = std::stoull(optarg);
+          break;
+        default:
+          throw std::invalid_argument("Unknown option");
+      }
+    }
+
+    if (optind + 1 != argc)
+      throw std::invalid_argument("Expected exactly one target directory");
+
+    const fs::path dir = fs::absolute(argv[optind]);
+    if (fs::exists(dir / ".srdp"))
+      throw std::invalid_argument("Target directory already contains a project");
+
+    fs::create_directories(dir);
+    fs::current_path(dir);
+    srdp::Srdp::init("./");
+
+    srdp::Srdp dp;
+    dp.create_project(project);
+
+    srdp::Generator gen(dp, opts);
+    gen.run();
+
+    std::cout << "Created " << gen.experiments.size() << " experiments, "
+      << gen.files << " files, " << gen.bytes << " bytes in " << dir.string() << "\n";
+  } catch (std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
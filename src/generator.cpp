@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <fstream>
+
+#include "generator.h"
+
+namespace srdp {
+
+  Generator::Generator(Srdp& srdpin, const GeneratorOptions& optsin) :
+    srdp(srdpin),
+    opts(optsin),
+    rng(optsin.seed)
+  {
+    if (opts.depth == 0 || opts.dir_width == 0)
+      throw std::invalid_argument("Depth and directory width must be at least 1");
+
+    if (opts.min_size > opts.max_size)
+      throw std::invalid_argument("Minimum file size is larger than maximum");
+  }
+
+  fs::path Generator::write_file(){
+    const size_t id = counter++;
+
+    // Spread evenly over the directory tree
+    fs::path path = srdp.get_top_level_dir();
+    size_t index = id;
+    for (size_t level=0; level < opts.dir_depth; level++) {
+      path /= "d" + std::to_string(level) + "_" + std::to_string(index % opts.dir_width);
+      index /= opts.dir_width;
+    }
+    fs::create_directories(path);
+    path /= "f" + std::to_string(id) + ".dat";
+
+    const size_t size = std::uniform_int_distribution<size_t>(opts.min_size, opts.max_size)(rng);
+
+    // The id keeps the content distinct
+    std::string content = std::to_string(opts.seed) + " " + std::to_string(id) + "\n";
+    content.reserve(size);
+    while (content.size() < size)
+      content += char('a' + rng() % 26);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+    if (!file)
+      throw std::runtime_error("Can not write " + path.string());
+
+    files++;
+    bytes += content.size();
+
+    return path;
+  }
+
+  void Generator::run(){
+    std::vector<fs::path> previous; // outputs of the previous generation
+    std::vector<fs::path> current;
+
+    for (size_t i=0; i < opts.experiments; i++) {
+      const size_t generation = i * opts.depth / opts.experiments;
+      const std::string name = "g" + std::to_string(generation) + "_e" + std::to_string(i);
+
+      // First experiment of a new generation
+      if (i > 0 && generation != (i - 1) * opts.depth / opts.experiments) {
+        previous = std::move(current);
+        current.clear();
+      }
+
+      Experiment exp = srdp.create_experiment(name);
+      experiments.push_back(name);
+
+      if (!previous.empty()) {
+        std::vector<fs::path> inputs;
+        for (size_t j=0; j < opts.fan_in && j < previous.size(); j++)
+          inputs.push_back(previous[rng() % previous.size()]);
+
+        std::sort(inputs.begin(), inputs.end());
+        inputs.erase(std::unique(inputs.begin(), inputs.end()), inputs.end());
+        srdp.add_files(exp, inputs, File::role_t::input);
+      }
+
+      std::vector<fs::path> names;
+      for (size_t j=0; j < opts.files; j++)
+        names.push_back(write_file());
+
+      srdp.add_files(exp, names, File::role_t::output);
+      current.insert(current.end(), names.begin(), names.end());
+    }
+
+    outputs = std::move(current);
+
+    for (size_t i=0; i < opts.untracked; i++)
+      write_file();
+  }
+}
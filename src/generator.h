@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_GENERATOR_H
+#define SRDP_GENERATOR_H
+
+#include <random>
+
+#include "srdp.h"
+
+namespace srdp {
+
+  struct GeneratorOptions {
+    size_t experiments = 10;
+    size_t files = 100;      // output files per experiment
+    size_t depth = 3;        // generations of experiments (lineage depth)
+    size_t fan_in = 2;       // inputs per experiment taken from the previous generation
+    size_t min_size = 16;    // file sizes in bytes
+    size_t max_size = 4096;
+    size_t dir_depth = 2;    // directory tree the files are spread over
+    size_t dir_width = 4;
+    size_t untracked = 0;    // files not added to any experiment
+    uint64_t seed = 1;
+  };
+
+  /**
+   * Synthetic projects for benchmarks (dp-gen, srdp_bench).
+   *
+   * Experiments are arranged in generations. Every experiment writes
+   * its own output files and takes outputs of the previous generation
+   * as inputs, which gives lineage chains of the given depth.
+   * All files have distinct content and are spread evenly over the
+   * directory tree. The same options and seed give the same project.
+   */
+  class Generator {
+    private:
+      Srdp& srdp;
+      GeneratorOptions opts;
+      std::mt19937_64 rng;
+      size_t counter = 0;
+
+    public:
+      std::vector<std::string> experiments;  // names, one generation after the other
+      std::vector<fs::path> outputs;         // of the last generation
+      size_t files = 0;                      // files written
+      size_t bytes = 0;
+
+      Generator(Srdp& srdp, const GeneratorOptions& opts);
+
+      // Populate the project
+      void run();
+
+      // Write a new file with distinct content, returns its path
+      fs::path write_file();
+  };
+}
+
+#endif /* SRDP_GENERATOR_H */
@@ -0,0 +1,323 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+
+#include "glob_matcher.h"
+
+namespace srdp {
+
+  static bool has_special(std::string_view str){
+    return str.find_first_of("*?[\\") != std::string_view::npos;
+  }
+
+  static void add_length(std::vector<size_t>& lengths, size_t length){
+    auto it = std::lower_bound(lengths.begin(), lengths.end(), length);
+    if (it == lengths.end() || *it != length)
+      lengths.insert(it, length);
+  }
+
+  static void set_max(std::unordered_map<std::string, int>& map, const std::string& key, int id){
+    auto [it, inserted] = map.emplace(key, id);
+    if (!inserted) it->second = std::max(it->second, id);
+  }
+
+  static bool test_bit(const std::vector<uint64_t>& bits, size_t i){
+    return (bits[i / 64] >> (i % 64)) & 1;
+  }
+
+  static void set_bit(std::vector<uint64_t>& bits, size_t i){
+    bits[i / 64] |= uint64_t(1) << (i % 64);
+  }
+
+  GlobMatcher::GlobMatcher(bool path_mode) : path_mode(path_mode), advance(256), stay(256) {}
+
+  void GlobMatcher::resize(size_t states){
+    const size_t words = (states + 63) / 64;
+    for (auto& b : advance) b.resize(words);
+    for (auto& b : stay) b.resize(words);
+    initial.resize(words);
+    star.resize(words);
+    nstates = states;
+  }
+
+  void GlobMatcher::add_to_nfa(const tokens_t& tokens, int id){
+    // States first .. first + n - 1 consume one token each, first + n accepts
+    const size_t first = nstates;
+    const size_t n = tokens.size();
+    resize(first + n + 1);
+
+    set_bit(initial, first);
+
+    for (size_t i=0; i < n; i++) {
+      const size_t state = first + i;
+      if (tokens[i].star) set_bit(star, state);
+
+      for (unsigned c=0; c < 256; c++) {
+        if (!tokens[i].set.test(c)) continue;
+        set_bit(tokens[i].star ? stay[c] : advance[c], state);
+      }
+    }
+
+    accepting.emplace_back(first + n, id);
+    std::stable_sort(accepting.begin(), accepting.end(),
+        [](const auto& a, const auto& b) { return a.second > b.second; });
+  }
+
+  std::vector<GlobMatcher::tokens_t> GlobMatcher::parse(const std::string& glob) const {
+    std::bitset<256> any;
+    any.set();
+    std::bitset<256> any_in_dir = any;
+    if (path_mode) any_in_dir.reset('/');
+
+    // "**/" can be skipped or not, each creates an alternative
+    std::vector<tokens_t> alternatives(1);
+
+    auto append = [&](const std::bitset<256>& set, bool is_star) {
+      for (auto& tokens : alternatives) {
+        // Consecutive stars are merged
+        if (is_star && !tokens.empty() && tokens.back().star)
+          tokens.back().set |= set;
+        else
+          tokens.push_back(token_t{set, is_star});
+      }
+    };
+
+    std::bitset<256> slash;
+    slash.set('/');
+
+    const size_t size = glob.size();
+    for (size_t i=0; i < size; i++) {
+      const char c = glob[i];
+      const bool at_start = i == 0 || glob[i - 1] == '/';
+
+      if (path_mode && c == '*' && i + 1 < size && glob[i + 1] == '*' && at_start) {
+        // "**/": zero or more directories
+        if (i + 2 < size && glob[i + 2] == '/') {
+          const size_t n = alternatives.size();
+          for (size_t j=0; j < n; j++) {
+            tokens_t tokens = alternatives[j];
+            if (!tokens.empty() && tokens.back().star)
+              tokens.back().set |= any;
+            else
+              tokens.push_back(token_t{any, true});
+            tokens.push_back(token_t{slash, false});
+            alternatives.push_back(std::move(tokens));
+          }
+          i += 2;
+          continue;
+        }
+
+        // Trailing "/**": everything inside
+        if (i + 2 == size && i > 0) {
+          append(any, false);
+          append(any, true);
+          i += 1;
+          continue;
+        }
+      }
+
+      switch (c) {
+        case '*':
+          append(any_in_dir, true);
+          break;
+        case '?':
+          append(any_in_dir, false);
+          break;
+        case '[': {
+          // Character class, taken literally if not terminated
+          size_t j = i + 1;
+          bool negate = false;
+          if (j < size && (glob[j] == '!' || glob[j] == '^')) {
+            negate = true;
+            j++;
+          }
+
+          std::bitset<256> set;
+          bool first = true;
+          for (; j < size && (first || glob[j] != ']'); j++) {
+            first = false;
+            unsigned char lo = glob[j];
+            if (lo == '\\' && j + 1 < size) lo = glob[++j];
+            unsigned char hi = lo;
+            if (j + 2 < size && glob[j + 1] == '-' && glob[j + 2] != ']') {
+              hi = glob[j + 2];
+              j += 2;
+            }
+            for (unsigned x=lo; x <= hi; x++) set.set(x);
+          }
+
+          if (j >= size) {
+            std::bitset<256> literal;
+            literal.set('[');
+            append(literal, false);
+            break;
+          }
+
+          if (negate) set.flip();
+          if (path_mode) set.reset('/');
+          append(set, false);
+          i = j;
+          break;
+        }
+        case '\\':
+          if (i + 1 < size) i++;
+          [[fallthrough]];
+        default: {
+          std::bitset<256> literal;
+          literal.set(static_cast<unsigned char>(glob[i]));
+          append(literal, false);
+        }
+      }
+    }
+
+    return alternatives;
+  }
+
+  void GlobMatcher::add(const std::string& glob, int id){
+    // Fast paths
+    if (!has_special(glob)) {
+      set_max(literals, glob, id);
+      return;
+    }
+
+    // Star matches '/' only outside of path mode
+    if (!path_mode && glob.size() > 0) {
+      const std::string_view view(glob);
+
+      if (glob.back() == '*' && !has_special(view.substr(0, glob.size() - 1))) {
+        const std::string prefix = glob.substr(0, glob.size() - 1);
+        set_max(prefixes, prefix, id);
+        add_length(prefix_lengths, prefix.size());
+        return;
+      }
+
+      if (glob[0] == '*' && !has_special(view.substr(1))) {
+        const std::string suffix = glob.substr(1);
+        set_max(suffixes, suffix, id);
+        add_length(suffix_lengths, suffix.size());
+        return;
+      }
+    }
+
+    for (const auto& tokens : parse(glob))
+      add_to_nfa(tokens, id);
+  }
+
+  bool GlobMatcher::empty() const {
+    return literals.empty() && prefixes.empty() && suffixes.empty() && nstates == 0;
+  }
+
+  int GlobMatcher::match_tables(std::string_view str) const {
+    int best = -1;
+
+    // Reused between calls to avoid allocations
+    thread_local std::string key;
+
+    auto lookup = [&](const std::unordered_map<std::string, int>& map, std::string_view k) {
+      key.assign(k.data(), k.size());
+      auto it = map.find(key);
+      if (it != map.end()) best = std::max(best, it->second);
+    };
+
+    if (!literals.empty()) lookup(literals, str);
+
+    for (size_t len : prefix_lengths) {
+      if (len > str.size()) break;
+      lookup(prefixes, str.substr(0, len));
+    }
+
+    for (size_t len : suffix_lengths) {
+      if (len > str.size()) break;
+      lookup(suffixes, str.substr(str.size() - len));
+    }
+
+    return best;
+  }
+
+  void GlobMatcher::close(bits_t& bits) const {
+    // A star state also enables the state after it
+    uint64_t carry = 0;
+    for (size_t w=0; w < bits.size(); w++) {
+      const uint64_t s = bits[w] & star[w];
+      bits[w] |= ((s << 1) | carry) & ~initial[w];
+      carry = s >> 63;
+    }
+  }
+
+  bool GlobMatcher::consume(bits_t& active, std::string_view str) const {
+    const size_t words = active.size();
+    thread_local bits_t next;
+    next.resize(words);
+
+    for (char ch : str) {
+      const unsigned char c = static_cast<unsigned char>(ch);
+      const bits_t& adv = advance[c];
+      const bits_t& st = stay[c];
+
+      uint64_t carry = 0;
+      uint64_t any = 0;
+      for (size_t w=0; w < words; w++) {
+        const uint64_t a = active[w] & adv[w];
+        next[w] = (((a << 1) | carry) & ~initial[w]) | (active[w] & st[w]);
+        carry = a >> 63;
+        any |= next[w];
+      }
+
+      if (!any) return false;
+
+      close(next);
+      active.swap(next);
+    }
+
+    return true;
+  }
+
+  int GlobMatcher::accepted(const bits_t& active, int best) const {
+    for (const auto& [state, id] : accepting) {
+      if (id <= best) break;
+      if (test_bit(active, state)) return id;
+    }
+    return best;
+  }
+
+  GlobMatcher::prefix_t GlobMatcher::start(std::string_view prefix) const {
+    prefix_t p;
+    p.length = prefix.size();
+
+    if (nstates > 0) {
+      p.active = initial;
+      close(p.active);
+      p.dead = !consume(p.active, prefix);
+    }
+
+    return p;
+  }
+
+  int GlobMatcher::match(std::string_view str) const {
+    const int best = match_tables(str);
+
+    // Patterns with an id below the best match can not change the result
+    if (nstates == 0 || accepting.front().second <= best) return best;
+
+    thread_local bits_t active;
+    active.assign(initial.begin(), initial.end());
+    close(active);
+
+    if (!consume(active, str)) return best;
+    return accepted(active, best);
+  }
+
+  int GlobMatcher::match(const prefix_t& prefix, std::string_view str) const {
+    const int best = match_tables(str);
+
+    if (nstates == 0 || prefix.dead || accepting.front().second <= best) return best;
+
+    thread_local bits_t active;
+    active.assign(prefix.active.begin(), prefix.active.end());
+
+    if (!consume(active, str.substr(prefix.length))) return best;
+    return accepted(active, best);
+  }
+}
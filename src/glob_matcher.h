@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_GLOB_MATCHER_H
+#define SRDP_GLOB_MATCHER_H
+
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace srdp {
+
+  /**
+   * Match a string against a set of glob patterns in one pass.
+   *
+   * Literal patterns and patterns of the form "prefix*" and "*suffix"
+   * are looked up in hash tables. All other patterns are compiled into
+   * one combined NFA, which is simulated bit-parallel with one bit per
+   * state, so the cost per character does not depend on the number of
+   * patterns but only on the total number of states / 64.
+   *
+   * Supported syntax: '*' matches any sequence, '?' any single character,
+   * "[a-z]" and "[!a-z]" a character class, and '\\' escapes the next
+   * character. In path mode '*', '?', and classes do not match '/',
+   * and "**" as a whole path component matches any number of
+   * directories (gitignore semantics).
+   */
+  class GlobMatcher {
+    private:
+      using bits_t = std::vector<uint64_t>;
+
+      struct token_t {
+        std::bitset<256> set;
+        bool star;
+      };
+      using tokens_t = std::vector<token_t>;
+
+      bool path_mode;
+
+      std::unordered_map<std::string, int> literals;
+      std::unordered_map<std::string, int> prefixes;
+      std::unordered_map<std::string, int> suffixes;
+      std::vector<size_t> prefix_lengths;
+      std::vector<size_t> suffix_lengths;
+
+      // Combined NFA, one bit per state
+      size_t nstates = 0;
+      std::vector<bits_t> advance; // [c] states left on c to the next state
+      std::vector<bits_t> stay;    // [c] star states that stay on c
+      bits_t initial;              // first state of each pattern
+      bits_t star;                 // star states, also active in the next state
+      std::vector<std::pair<size_t, int>> accepting; // (state, id), ordered by id descending
+
+      std::vector<tokens_t> parse(const std::string& glob) const;
+      int match_tables(std::string_view str) const;
+      void close(bits_t& bits) const;
+      bool consume(bits_t& active, std::string_view str) const;
+      int accepted(const bits_t& active, int best) const;
+      void add_to_nfa(const tokens_t& tokens, int id);
+      void resize(size_t states);
+
+    public:
+      // NFA state after a common prefix of many strings
+      struct prefix_t {
+        bits_t active;
+        size_t length = 0;
+        bool dead = false; // no pattern can match anymore
+      };
+
+      GlobMatcher(bool path_mode = false);
+
+      /* Add a pattern.
+       *
+       * id is returned by match() if the pattern matches.
+       */
+      void add(const std::string& glob, int id);
+
+      /**
+       * Highest id of all matching patterns, -1 if none matches.
+       */
+      int match(std::string_view str) const;
+
+      /* Run the NFA over a prefix once.
+       *
+       * Strings starting with the prefix can then be matched with
+       * match(prefix, str) without consuming the prefix again.
+       */
+      prefix_t start(std::string_view prefix) const;
+      int match(const prefix_t& prefix, std::string_view str) const;
+
+      bool empty() const;
+  };
+}
+
+#endif /* SRDP_GLOB_MATCHER_H */
@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "glob_matcher.h"
+
+TEST_CASE("Glob matching", "[glob]") {
+  srdp::GlobMatcher matcher;
+  REQUIRE( matcher.empty() );
+  REQUIRE( matcher.match("anything") == -1 );
+
+  matcher.add("build", 0);      // literal
+  matcher.add("tmp*", 1);       // prefix
+  matcher.add("*.o", 2);        // suffix
+  matcher.add("a?c*.log", 3);   // automaton
+  matcher.add("*x*y*", 4);      // automaton
+  REQUIRE_FALSE( matcher.empty() );
+
+  REQUIRE( matcher.match("build") == 0 );
+  REQUIRE( matcher.match("build2") == -1 );
+  REQUIRE( matcher.match("tmp") == 1 );
+  REQUIRE( matcher.match("tmpfile") == 1 );
+  REQUIRE( matcher.match("main.o") == 2 );
+  REQUIRE( matcher.match("main.oo") == -1 );
+  REQUIRE( matcher.match("abc.log") == 3 );
+  REQUIRE( matcher.match("axc-run.log") == 3 );
+  REQUIRE( matcher.match("ac.log") == -1 );
+  REQUIRE( matcher.match("abc.log.gz") == -1 );
+  REQUIRE( matcher.match("xy") == 4 );
+  REQUIRE( matcher.match("1x2y3") == 4 );
+  REQUIRE( matcher.match("yx") == -1 );
+
+  // Highest id of several matches
+  REQUIRE( matcher.match("tmp.o") == 2 );
+  REQUIRE( matcher.match("tmpxy") == 4 );
+  REQUIRE( matcher.match("abcxy.log") == 4 );
+
+  matcher.add("*", 5);
+  REQUIRE( matcher.match("") == 5 );
+  REQUIRE( matcher.match("build") == 5 );
+}
+
+TEST_CASE("Glob matching with many patterns", "[glob]") {
+  srdp::GlobMatcher matcher;
+
+  // More than 64 NFA states
+  for (int i=0; i < 100; i++)
+    matcher.add("f?" + std::to_string(i) + "*z", i);
+
+  REQUIRE( matcher.match("fa0z") == 0 );
+  REQUIRE( matcher.match("fb99-z") == 99 );
+  REQUIRE( matcher.match("fb99-") == -1 );
+  REQUIRE( matcher.match("fb100z") == 10 );
+}
+
+TEST_CASE("Glob syntax", "[glob]") {
+  srdp::GlobMatcher matcher;
+  matcher.add("file[0-9].txt", 0);
+  matcher.add("[!a]x", 1);
+  matcher.add("\\*star", 2);
+
+  REQUIRE( matcher.match("file5.txt") == 0 );
+  REQUIRE( matcher.match("filex.txt") == -1 );
+  REQUIRE( matcher.match("bx") == 1 );
+  REQUIRE( matcher.match("ax") == -1 );
+  REQUIRE( matcher.match("*star") == 2 );
+  REQUIRE( matcher.match("xstar") == -1 );
+}
+
+TEST_CASE("Glob path mode", "[glob]") {
+  srdp::GlobMatcher matcher(true);
+  matcher.add("doc/*.txt", 0);
+  matcher.add("**/build", 1);
+  matcher.add("a/**/b", 2);
+  matcher.add("out/**", 3);
+
+  REQUIRE( matcher.match("doc/x.txt") == 0 );
+  REQUIRE( matcher.match("doc/sub/x.txt") == -1 );
+
+  REQUIRE( matcher.match("build") == 1 );
+  REQUIRE( matcher.match("x/y/build") == 1 );
+
+  REQUIRE( matcher.match("a/b") == 2 );
+  REQUIRE( matcher.match("a/x/b") == 2 );
+  REQUIRE( matcher.match("a/x/y/b") == 2 );
+  REQUIRE( matcher.match("ab") == -1 );
+
+  REQUIRE( matcher.match("out/x") == 3 );
+  REQUIRE( matcher.match("out/x/y") == 3 );
+  REQUIRE( matcher.match("out") == -1 );
+
+  // Shared prefix state
+  auto doc = matcher.start("doc/");
+  REQUIRE( matcher.match(doc, "doc/x.txt") == 0 );
+  REQUIRE( matcher.match(doc, "doc/x.bin") == -1 );
+  REQUIRE( matcher.match(doc, "doc/build") == 1 );
+
+  auto a = matcher.start("a/x/");
+  REQUIRE( matcher.match(a, "a/x/b") == 2 );
+  REQUIRE( matcher.match(a, "a/x/c") == -1 );
+}
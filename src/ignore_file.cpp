@@ -4,96 +4,264 @@
 
 
 #include "ignore_file.h"
+#include "timings.h"
+#include "sys_calls.h"
 
 namespace srdp {
 
+  static void fnv_update(uint64_t& hash, std::string_view str) {
+      // FNV-1a, string terminated by newline
+      for (char c : str) {
+          hash ^= static_cast<unsigned char>(c);
+          hash *= 1099511628211ull;
+      }
+      hash ^= '\n';
+      hash *= 1099511628211ull;
+  }
+
   IgnoreFile::IgnoreFile(fs::path ignore_file) {
     load_from_file(ignore_file);
   }
 
-  // Helper to convert a glob string into a valid std::regex string
-  std::string IgnoreFile::glob_to_regex(const std::string& glob) {
-      std::string regex_str = "^";
-      for (char c : glob) {
-          switch (c) {
-              case '*':
-                  regex_str += ".*";
-                  break;
-              case '?':
-                  regex_str += ".";
-                  break;
-              case '.': case '+': case '^': case '$': case '|':
-              case '(': case ')': case '[': case ']': case '{': case '}':
-                  regex_str += "\\";
-                  regex_str += c;
-                  break;
-              default:
-                  regex_str += c;
-                  break;
-          }
+  void IgnoreFile::update_fingerprint(const std::string& pattern) {
+      fnv_update(fingerprint, pattern);
+  }
+
+  void IgnoreFile::add_rule(std::string pattern) {
+      bool negate = false;
+      if (pattern[0] == '!') {
+          negate = true;
+          pattern.erase(0, 1);
+      }
+
+      bool dir_only = false;
+      if (!pattern.empty() && pattern.back() == '/') {
+          dir_only = true;
+          pattern.pop_back();
+      }
+
+      // A slash other than at the end anchors the pattern
+      const bool anchored = pattern.find('/') != std::string::npos;
+      if (anchored && pattern[0] == '/') pattern.erase(0, 1);
+
+      if (pattern.empty()) return;
+
+      const int id = negation.size();
+      negation.push_back(negate);
+
+      if (anchored) {
+          dir_path_rules.add(pattern, id);
+          if (!dir_only) file_path_rules.add(pattern, id);
+      } else {
+          dir_rules.add(pattern, id);
+          if (!dir_only) file_rules.add(pattern, id);
       }
-      regex_str += "$";
-      return regex_str;
   }
 
   void IgnoreFile::load_from_file(const fs::path& file_path) {
-      std::ifstream file(file_path);
+      std::ifstream file = sys::ifstream(file_path);
       if (!file.is_open()) return;
 
       std::string line;
       while (std::getline(file, line)) {
-          // Trim whitespace
-          line.erase(0, line.find_first_not_of(" \t\r\n"));
-          line.erase(line.find_last_not_of(" \t\r\n") + 1);
+          // Trim trailing whitespace unless escaped
+          size_t end = line.size();
+          while (end > 0 && (line[end - 1] == ' ' || line[end - 1] == '\t' || line[end - 1] == '\r')
+              && !(end > 1 && line[end - 2] == '\\')) {
+              end--;
+          }
+          line.resize(end);
 
           // Skip empty lines and comments
           if (line.empty() || line[0] == '#') {
               continue;
           }
 
-          bool dir_only = false;
-          if (line.back() == '/') {
-              dir_only = true;
-              line.pop_back();
-          }
-
-          try {
-              ignore_rule rule;
-              rule.pattern_regex = std::regex(glob_to_regex(line));
-              rule.is_directory_only = dir_only;
-              rule.is_negation = false;
-              rules.push_back(rule);
-          } catch (const std::regex_error&) {
-              continue;
-          }
+          update_fingerprint(line);
+          add_rule(line);
       }
   }
 
   void IgnoreFile::add_pattern(std::string pattern) {
       if (pattern.empty() || pattern[0] == '#') return;
 
-      bool dir_only = false;
-      if (pattern.back() == '/') {
-          dir_only = true;
-          pattern.pop_back();
+      update_fingerprint(pattern);
+      add_rule(pattern);
+  }
+
+  IgnoreFile::match_t IgnoreFile::match(std::string_view rel_path, bool is_dir) const {
+      const size_t slash = rel_path.rfind('/');
+      const std::string_view name = slash == std::string_view::npos ? rel_path : rel_path.substr(slash + 1);
+
+      const int best = std::max(
+          (is_dir ? dir_rules : file_rules).match(name),
+          (is_dir ? dir_path_rules : file_path_rules).match(rel_path));
+
+      if (best < 0) return match_t::none;
+      return negation[best] ? match_t::included : match_t::ignored;
+  }
+
+  IgnoreFile::prefix_t IgnoreFile::prefix(std::string_view dir) const {
+      return prefix_t{file_path_rules.start(dir), dir_path_rules.start(dir)};
+  }
+
+  IgnoreFile::match_t IgnoreFile::match(const prefix_t& prefix, std::string_view rel_path, bool is_dir) const {
+      const size_t slash = rel_path.rfind('/');
+      const std::string_view name = slash == std::string_view::npos ? rel_path : rel_path.substr(slash + 1);
+
+      const int best = std::max(
+          (is_dir ? dir_rules : file_rules).match(name),
+          is_dir ? dir_path_rules.match(prefix.dirs, rel_path) : file_path_rules.match(prefix.files, rel_path));
+
+      if (best < 0) return match_t::none;
+      return negation[best] ? match_t::included : match_t::ignored;
+  }
+
+  void IgnoreTree::set_root(const fs::path& root_dir, const std::vector<fs::path>& names) {
+      root = root_dir;
+      file_names = names;
+      clear_cache();
+  }
+
+  void IgnoreTree::add_internal_pattern(const std::string& pattern) {
+      internal.add_pattern(pattern);
+      clear_cache();
+  }
+
+  void IgnoreTree::clear_cache() {
+      std::lock_guard<std::mutex> lock(mutex);
+      cache.clear();
+  }
+
+  uint64_t IgnoreTree::get_fingerprint() const {
+      uint64_t hash = internal.get_fingerprint();
+      for (const auto& name : file_names)
+          fnv_update(hash, name.string());
+      return hash;
+  }
+
+  std::shared_ptr<const IgnoreTree::Rules> IgnoreTree::get_rules(const std::string& rel_dir_in) const {
+      const std::string rel_dir = rel_dir_in == "." ? std::string() : rel_dir_in;
+
+      {
+          std::lock_guard<std::mutex> lock(mutex);
+          auto it = cache.find(rel_dir);
+          if (it != cache.end()) return it->second;
+      }
+
+      std::shared_ptr<const Rules> parent;
+      if (!rel_dir.empty()) {
+          const size_t slash = rel_dir.rfind('/');
+          parent = get_rules(slash == std::string::npos ? std::string() : rel_dir.substr(0, slash));
       }
 
-      rules.push_back({std::regex(glob_to_regex(pattern)), dir_only, false});
+      auto rules = std::make_shared<Rules>();
+      for (const auto& name : file_names)
+          rules->rules.load_from_file(root / rel_dir / name);
+
+      // Directories without ignore files share the rules of their parent
+      std::shared_ptr<const Rules> result = parent;
+      if (!parent || !rules->rules.empty()) {
+          rules->parent = parent;
+          rules->base = rel_dir;
+          rules->fingerprint = parent ? parent->fingerprint : get_fingerprint();
+          fnv_update(rules->fingerprint, rel_dir);
+          fnv_update(rules->fingerprint, std::to_string(rules->rules.get_fingerprint()));
+          result = rules;
+      }
+
+      std::lock_guard<std::mutex> lock(mutex);
+      return cache.emplace(rel_dir, result).first->second;
   }
 
-  bool IgnoreFile::is_ignored(const fs::path& path) const {
-      std::string filename = path.filename().string();
-      bool is_dir = fs::is_directory(path);
+  bool IgnoreTree::is_ignored(const Rules& rules, std::string_view rel_path, bool is_dir) const {
+      if (internal.match(rel_path, is_dir) == IgnoreFile::match_t::ignored)
+          return true;
+
+      // Deepest rules first, the first match decides
+      for (const Rules* r = &rules; r; r = r->parent.get()) {
+          std::string_view rel = rel_path;
+          if (!r->base.empty()) {
+              if (rel.size() <= r->base.size() || rel.compare(0, r->base.size(), r->base) != 0
+                  || rel[r->base.size()] != '/') {
+                  continue;
+              }
+              rel.remove_prefix(r->base.size() + 1);
+          }
+
+          const auto m = r->rules.match(rel, is_dir);
+          if (m != IgnoreFile::match_t::none) return m == IgnoreFile::match_t::ignored;
+      }
 
-      for (const auto& rule : rules) {
-          if (rule.is_directory_only && !is_dir) {
+      return false;
+  }
+
+  bool IgnoreTree::is_ignored(std::string_view rel_path, bool is_dir) const {
+      Timings::Span span("ignore.match");
+      const size_t slash = rel_path.rfind('/');
+      const std::string dir(slash == std::string_view::npos ? std::string_view() : rel_path.substr(0, slash));
+      return is_ignored(*get_rules(dir), rel_path, is_dir);
+  }
+
+  bool IgnoreTree::is_ignored(const fs::path& path) const {
+      const bool is_dir = fs::is_directory(path);
+
+      fs::path rel = root.empty() ? path.lexically_normal() : path.lexically_proximate(root);
+
+      // Outside of the tree only the file name can be matched
+      if (rel.empty() || *rel.begin() == "..")
+          rel = path.filename();
+
+      return is_ignored(rel.string(), is_dir);
+  }
+
+  std::vector<bool> IgnoreTree::is_ignored(std::string_view rel_dir, const std::vector<entry_t>& entries) const {
+      Timings::Span span("ignore.match");
+      std::vector<bool> ignored(entries.size(), false);
+      if (entries.empty()) return ignored;
+
+      const std::string dir = rel_dir == "." ? std::string() : std::string(rel_dir);
+      const auto rules = get_rules(dir);
+
+      std::string path = dir.empty() ? dir : dir + "/";
+      const size_t dir_length = path.size();
+
+      // Matcher state after the directory, for each level of rules
+      struct level_t {
+        const IgnoreFile* rules;
+        size_t offset;
+        IgnoreFile::prefix_t prefix;
+      };
+
+      const IgnoreFile::prefix_t internal_prefix = internal.prefix(path);
+
+      std::vector<level_t> levels;
+      for (const Rules* r = rules.get(); r; r = r->parent.get()) {
+          if (r->rules.empty()) continue;
+          const size_t offset = r->base.empty() ? 0 : r->base.size() + 1;
+          levels.push_back(level_t{&r->rules, offset, r->rules.prefix(std::string_view(path).substr(offset))});
+      }
+
+      for (size_t i=0; i < entries.size(); i++) {
+          path.resize(dir_length);
+          path += entries[i].name;
+          const bool is_dir = entries[i].is_dir;
+
+          if (internal.match(internal_prefix, path, is_dir) == IgnoreFile::match_t::ignored) {
+              ignored[i] = true;
               continue;
           }
 
-          if (std::regex_match(filename, rule.pattern_regex)) {
-              return true;
+          // Deepest rules first, the first match decides
+          for (const auto& level : levels) {
+              const auto m = level.rules->match(level.prefix, std::string_view(path).substr(level.offset), is_dir);
+              if (m != IgnoreFile::match_t::none) {
+                  ignored[i] = m == IgnoreFile::match_t::ignored;
+                  break;
+              }
           }
       }
-      return false;
+
+      return ignored;
   }
 }
@@ -8,10 +8,14 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <regex>
+#include <string_view>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
+#include "glob_matcher.h"
 #include "cmake_config.h"
 
 
@@ -20,17 +24,43 @@ namespace srdp {
 
 namespace fs = std::filesystem;
 
+  /**
+   * Rules of one ignore file (gitignore syntax).
+   *
+   * Patterns without a slash match the file name at any depth, patterns
+   * with a slash are anchored to the directory of the ignore file.
+   * A trailing slash restricts a rule to directories, a leading '!'
+   * re-includes what an earlier rule excluded. The last matching rule wins.
+   */
   class IgnoreFile {
-    private:
-      struct ignore_rule {
-          std::regex pattern_regex;
-          bool is_directory_only;
-          bool is_negation;
+    public:
+      enum class match_t {
+        none,
+        ignored,
+        included
+      };
+
+      // Matcher state after the directory part of a path
+      struct prefix_t {
+        GlobMatcher::prefix_t files;
+        GlobMatcher::prefix_t dirs;
       };
 
-    std::vector<ignore_rule> rules;
+    private:
+      // Rules matching the file name, for files and for directories
+      GlobMatcher file_rules;
+      GlobMatcher dir_rules;
+
+      // Rules matching the path relative to the ignore file's directory
+      GlobMatcher file_path_rules{true};
+      GlobMatcher dir_path_rules{true};
+
+      std::vector<bool> negation;
+
+    uint64_t fingerprint = 14695981039346656037ull;
 
-    std::string glob_to_regex(const std::string& glob);
+    void update_fingerprint(const std::string& pattern);
+    void add_rule(std::string pattern);
 
   public:
       IgnoreFile() = default;
@@ -42,8 +72,100 @@ namespace fs = std::filesystem;
       // Add a single pattern manually
       void add_pattern(std::string pattern);
 
-      // Check if a given file path matches any of the rules
+      bool empty() const { return negation.empty(); }
+
+      /**
+       * Match a path relative to the directory of the ignore file.
+       */
+      match_t match(std::string_view rel_path, bool is_dir) const;
+
+      /* Match many paths of one directory.
+       *
+       * dir is the directory relative to the ignore file's directory,
+       * including a trailing slash, rel_path must start with it.
+       */
+      prefix_t prefix(std::string_view dir) const;
+      match_t match(const prefix_t& prefix, std::string_view rel_path, bool is_dir) const;
+
+      // Hash over all patterns, changes whenever a rule is added
+      uint64_t get_fingerprint() const { return fingerprint; }
+  };
+
+  /**
+   * Ignore rules of a directory tree.
+   *
+   * Every directory can hold ignore files, whose rules apply to the
+   * directory's subtree. Rules of deeper files take precedence over
+   * those of files further up. Internal patterns always win.
+   * The rules of each directory are loaded once and cached, the cache
+   * can be used from several threads.
+   */
+  class IgnoreTree {
+    public:
+      struct Rules {
+        std::shared_ptr<const Rules> parent;
+        std::string base;  // directory of the ignore files, relative to the root
+        IgnoreFile rules;
+        uint64_t fingerprint; // over this and all parent rules
+      };
+
+      struct entry_t {
+        std::string_view name;
+        bool is_dir;
+      };
+
+    private:
+      fs::path root;
+      std::vector<fs::path> file_names;
+      IgnoreFile internal;
+
+      mutable std::mutex mutex;
+      mutable std::unordered_map<std::string, std::shared_ptr<const Rules>> cache;
+
+    public:
+      IgnoreTree() = default;
+
+      /* Set the root directory and the names of the ignore files.
+       *
+       * All existing files of a directory are loaded in the given order,
+       * rules of later files take precedence.
+       */
+      void set_root(const fs::path& root, const std::vector<fs::path>& file_names);
+
+      // Add a pattern that applies everywhere and can not be overridden
+      void add_internal_pattern(const std::string& pattern);
+
+      // Drop all cached rules, e.g. after an ignore file has changed
+      void clear_cache();
+
+      /**
+       * Get the rules that apply inside a directory (relative to the root).
+       */
+      std::shared_ptr<const Rules> get_rules(const std::string& rel_dir) const;
+
+      // Check if a given file path matches any of the rules (needs a stat)
       bool is_ignored(const fs::path& path) const;
+
+      /**
+       * Check a path relative to the root.
+       */
+      bool is_ignored(std::string_view rel_path, bool is_dir) const;
+
+      /**
+       * Check a path relative to the root with the rules of its directory.
+       */
+      bool is_ignored(const Rules& rules, std::string_view rel_path, bool is_dir) const;
+
+      /**
+       * Check all entries of one directory (relative to the root).
+       *
+       * The rules are looked up once and the matchers run over the
+       * directory part only once for all entries.
+       */
+      std::vector<bool> is_ignored(std::string_view rel_dir, const std::vector<entry_t>& entries) const;
+
+      // Hash over internal patterns and ignore file names
+      uint64_t get_fingerprint() const;
   };
 }
 
@@ -0,0 +1,109 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <fstream>
+#include <catch2/catch_test_macros.hpp>
+
+#include "ignore_file.h"
+
+namespace fs = std::filesystem;
+using match_t = srdp::IgnoreFile::match_t;
+
+TEST_CASE("Ignore rules", "[ignore]") {
+  srdp::IgnoreFile ignore;
+  REQUIRE( ignore.empty() );
+
+  ignore.add_pattern("*.o");
+  ignore.add_pattern("build/");
+  ignore.add_pattern("/top.txt");
+  ignore.add_pattern("doc/*.tmp");
+  ignore.add_pattern("!keep.o");
+  ignore.add_pattern("# comment");
+  REQUIRE_FALSE( ignore.empty() );
+
+  REQUIRE( ignore.match("dir/main.o", false) == match_t::ignored );
+  REQUIRE( ignore.match("dir/main.c", false) == match_t::none );
+
+  // Negation, last rule wins
+  REQUIRE( ignore.match("dir/keep.o", false) == match_t::included );
+
+  // Directory only rule
+  REQUIRE( ignore.match("x/build", true) == match_t::ignored );
+  REQUIRE( ignore.match("x/build", false) == match_t::none );
+
+  // Anchored rules
+  REQUIRE( ignore.match("top.txt", false) == match_t::ignored );
+  REQUIRE( ignore.match("sub/top.txt", false) == match_t::none );
+  REQUIRE( ignore.match("doc/a.tmp", false) == match_t::ignored );
+  REQUIRE( ignore.match("sub/doc/a.tmp", false) == match_t::none );
+}
+
+TEST_CASE("Ignore tree", "[ignore]") {
+  const fs::path root = fs::absolute("test_ignore");
+  fs::create_directories(root / "sub" / "deep");
+
+  std::ofstream(root / ".srdpignore") << "*.log\n/data/\n";
+  std::ofstream(root / "sub" / ".srdpignore") << "!keep.log\nlocal.txt\n";
+  std::ofstream(root / "sub" / ".gitignore") << "keep.log\n*.bak\n";
+
+  srdp::IgnoreTree tree;
+  tree.set_root(root, {".gitignore", ".srdpignore"});
+  tree.add_internal_pattern(".srdpignore");
+
+  auto top = tree.get_rules(".");
+  auto sub = tree.get_rules("sub");
+  auto deep = tree.get_rules("sub/deep");
+
+  // Directories without ignore files share the rules of the parent
+  REQUIRE( deep == sub );
+  REQUIRE( top->fingerprint != sub->fingerprint );
+
+  REQUIRE( tree.is_ignored(*top, "a.log", false) );
+  REQUIRE( tree.is_ignored(*top, "data", true) );
+  REQUIRE_FALSE( tree.is_ignored(*top, "local.txt", false) );
+
+  // Deeper files take precedence, .srdpignore over .gitignore
+  REQUIRE( tree.is_ignored(*sub, "sub/a.log", false) );
+  REQUIRE_FALSE( tree.is_ignored(*sub, "sub/keep.log", false) );
+  REQUIRE( tree.is_ignored(*sub, "sub/local.txt", false) );
+  REQUIRE( tree.is_ignored(*sub, "sub/x.bak", false) );
+  REQUIRE( tree.is_ignored(*deep, "sub/deep/local.txt", false) );
+
+  // Anchored rules apply relative to their file
+  REQUIRE_FALSE( tree.is_ignored(*sub, "sub/data", true) );
+
+  // Internal patterns can not be overridden
+  REQUIRE( tree.is_ignored(*sub, "sub/.srdpignore", false) );
+
+  // Path interface
+  REQUIRE( tree.is_ignored(root / "sub" / "deep" / "x.log") );
+  REQUIRE_FALSE( tree.is_ignored(root / "sub" / "deep" / "keep.log") );
+
+  // Known type, no stat
+  REQUIRE( tree.is_ignored("data", true) );
+  REQUIRE_FALSE( tree.is_ignored("data", false) );
+  REQUIRE_FALSE( tree.is_ignored("sub/deep/keep.log", false) );
+
+  // Batch for one directory gives the same results
+  std::vector<srdp::IgnoreTree::entry_t> entries{
+    {"a.log", false}, {"keep.log", false}, {"local.txt", false}, {"data", true}, {".srdpignore", false}, {"x.c", false}};
+  REQUIRE( tree.is_ignored("sub/deep", entries) == std::vector<bool>{true, false, true, false, true, false} );
+  REQUIRE( tree.is_ignored(".", entries) == std::vector<bool>{true, true, false, true, true, false} );
+  for (const auto& dir : {"sub", "sub/deep", "."}) {
+    auto batch = tree.is_ignored(dir, entries);
+    for (size_t i=0; i < entries.size(); i++) {
+      const std::string path = std::string(dir) == "." ? std::string(entries[i].name) : std::string(dir) + "/" + std::string(entries[i].name);
+      REQUIRE( batch[i] == tree.is_ignored(path, entries[i].is_dir) );
+    }
+  }
+
+  // Changed files are picked up after clearing the cache
+  std::ofstream(root / "sub" / ".srdpignore") << "other.txt\n";
+  REQUIRE( tree.get_rules("sub")->fingerprint == sub->fingerprint );
+  tree.clear_cache();
+  REQUIRE( tree.get_rules("sub")->fingerprint != sub->fingerprint );
+  REQUIRE( tree.is_ignored(*tree.get_rules("sub"), "sub/keep.log", false) );
+
+  fs::remove_all(root);
+}
@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "journal.h"
+
+namespace srdp {
+
+  void Journal::create_table(Sql& db){
+    db.exec(R"(
+        CREATE TABLE IF NOT EXISTS journal_entries (
+          id INTEGER PRIMARY KEY,
+          owner BLOB(16) NOT NULL,
+          ctime INTEGER,
+          author TEXT,
+          text TEXT NOT NULL
+        );
+
+        CREATE INDEX IF NOT EXISTS idx_journal_owner ON journal_entries (owner, id);
+    )");
+  }
+
+  void Journal::migrate(Sql& db){
+    create_table(db);
+
+    // Existing journals become the first entry
+    db.exec(R"(
+        INSERT INTO journal_entries (owner, ctime, author, text)
+          SELECT uuid, ctime, owner, journal FROM projects
+          WHERE journal IS NOT NULL AND journal != '';
+
+        INSERT INTO journal_entries (owner, ctime, author, text)
+          SELECT uuid, ctime, owner, journal FROM experiments
+          WHERE journal IS NOT NULL AND journal != '';
+
+        ALTER TABLE projects DROP COLUMN journal;
+        ALTER TABLE experiments DROP COLUMN journal;
+    )");
+  }
+
+  Journal::Journal(const std::shared_ptr<Sql>& dbin, const uuids::uuid& owner_uuid) :
+    db(dbin), owner(owner_uuid)
+  {
+    if (!db)
+      throw std::runtime_error("Invalid DB pointer.");
+  }
+
+  void Journal::append(const std::string& text, const std::optional<std::string>& author, std::optional<ctime_t> ctime){
+    if (!ctime) ctime = get_timestamp_now();
+
+    db->query("INSERT INTO journal_entries (owner, ctime, author, text) VALUES (?, ?, ?, ?);",
+             Sql::vec_sql_t{bin_to_blob(owner), *ctime, Sql::optional_null(author), text});
+  }
+
+  void Journal::set(const std::string& text){
+    // Savepoint, so it also nests into an open transaction
+    db->exec("SAVEPOINT journal_set;");
+
+    try {
+      clear();
+      if (!text.empty()) append(text);
+      db->exec("RELEASE journal_set;");
+    } catch (...) {
+      db->exec("ROLLBACK TO journal_set; RELEASE journal_set;");
+      throw;
+    }
+  }
+
+  void Journal::clear(){
+    db->query("DELETE FROM journal_entries WHERE owner = ?;",
+             Sql::vec_sql_t{bin_to_blob(owner)});
+  }
+
+  std::vector<Journal::entry_t> Journal::read(int64_t after, size_t limit){
+    auto res = db->query(R"(
+        SELECT id, ctime, author, text FROM journal_entries
+        WHERE owner = ? AND id > ?
+        ORDER BY id
+        LIMIT ?;
+      )",
+             Sql::vec_sql_t{bin_to_blob(owner), after, int64_t(limit)},
+             Sql::vec_sql_t{int64_t(0),    // id
+                            int64_t(0),    // ctime
+                            std::string(), // author
+                            std::string()} // text
+             );
+
+    std::vector<entry_t> entries;
+
+    while (res) {
+      auto row = *res;
+
+      entry_t entry;
+      entry.id = std::get<int64_t>(*row[0]);
+      entry.ctime = Sql::sql_repack_optional<ctime_t>(row[1]);
+      entry.author = Sql::sql_repack_optional<std::string>(row[2]);
+      if (row[3]) entry.text = std::get<std::string>(*row[3]);
+      entries.push_back(std::move(entry));
+
+      res = db->next_row();
+    }
+
+    return entries;
+  }
+
+  size_t Journal::size(){
+    auto res = db->query("SELECT COUNT(*) FROM journal_entries WHERE owner = ?;",
+             Sql::vec_sql_t{bin_to_blob(owner)},
+             Sql::vec_sql_t{int64_t(0)});
+
+    size_t count = (res && (*res)[0]) ? std::get<int64_t>(*(*res)[0]) : 0;
+    while (res) res = db->next_row();
+
+    return count;
+  }
+
+  std::string Journal::get(){
+    std::string text;
+    int64_t last = 0;
+
+    for (auto page = read(); !page.empty(); page = read(last)) {
+      for (const auto& entry : page)
+        text += entry.text;
+      last = page.back().id;
+    }
+
+    return text;
+  }
+}
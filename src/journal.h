@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_JOURNAL_H
+#define SRDP_JOURNAL_H
+
+#include "project.h"
+
+namespace srdp {
+
+  /**
+   * Journal of a project or experiment.
+   *
+   * Every append is a row of its own in journal_entries,
+   * so appending does not rewrite the existing text.
+   * The journal text is the concatenation of all entries.
+   */
+  class Journal {
+    private:
+      std::shared_ptr<Sql> db;
+      uuids::uuid owner;
+
+    public:
+      struct entry_t {
+        int64_t id = 0;
+        std::optional<ctime_t> ctime;
+        std::optional<std::string> author;
+        std::string text;
+      };
+
+      static void create_table(Sql& db);
+
+      // Move the journal columns of projects and experiments into entries
+      static void migrate(Sql& db);
+
+      // Journal of a project or experiment
+      Journal(const std::shared_ptr<Sql>& dbin, const uuids::uuid& owner);
+
+      void append(const std::string& text,
+          const std::optional<std::string>& author = std::optional<std::string>(),
+          std::optional<ctime_t> ctime = std::optional<ctime_t>());
+
+      // Replace all entries by a single one
+      void set(const std::string& text);
+
+      // Remove all entries
+      void clear();
+
+      /**
+       * Read up to limit entries with an id larger than after.
+       * Pass the id of the last entry to get the next page.
+       */
+      std::vector<entry_t> read(int64_t after = 0, size_t limit = 100);
+
+      // Number of entries
+      size_t size();
+
+      // Concatenated text of all entries
+      std::string get();
+  };
+}
+
+#endif /* SRDP_JOURNAL_H */
@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "journal.h"
+#include "experiment.h"
+
+const std::filesystem::path journal_db_path("test_journal.db");
+
+TEST_CASE("Journal entries", "[journal]") {
+  std::filesystem::remove(journal_db_path);
+  std::shared_ptr<srdp::Sql> db = std::make_shared<srdp::Sql>(journal_db_path);
+
+  REQUIRE_NOTHROW( srdp::Project::create_table(*db) );
+  REQUIRE_NOTHROW( srdp::Experiment::create_table(*db) );
+
+  srdp::Project project(db, "project", true);
+  srdp::Journal journal = project.journal();
+
+  REQUIRE( journal.size() == 0 );
+  REQUIRE( journal.get() == "" );
+
+  REQUIRE_NOTHROW( journal.append("first", std::string("author"), 42) );
+  REQUIRE_NOTHROW( journal.append(" second") );
+  REQUIRE( journal.size() == 2 );
+  REQUIRE( journal.get() == "first second" );
+
+  auto entries = journal.read();
+  REQUIRE( entries.size() == 2 );
+  REQUIRE( entries[0].author == "author" );
+  REQUIRE( entries[0].ctime == 42 );
+  REQUIRE_FALSE( entries[1].author );
+  REQUIRE( entries[1].ctime );
+
+  SECTION("Pages") {
+    for (int i=0; i < 10; i++)
+      journal.append(std::to_string(i));
+
+    std::string text;
+    int64_t last = 0;
+    size_t pages = 0;
+    for (auto page = journal.read(0, 5); !page.empty(); page = journal.read(last, 5)) {
+      REQUIRE( page.size() <= 5 );
+      for (const auto& e : page) text += e.text;
+      last = page.back().id;
+      pages++;
+    }
+
+    REQUIRE( pages == 3 );
+    REQUIRE( text == journal.get() );
+    REQUIRE( text == "first second0123456789" );
+  }
+
+  SECTION("Journals are separate") {
+    srdp::Experiment exp(db, project, "experiment", true);
+    REQUIRE_NOTHROW( exp.append_journal("experiment") );
+    REQUIRE( exp.get_journal() == "experiment" );
+    REQUIRE( project.get_journal() == "first second" );
+
+    REQUIRE_NOTHROW( exp.remove() );
+    REQUIRE( srdp::Journal(db, exp.uuid).size() == 0 );
+    REQUIRE( project.get_journal() == "first second" );
+  }
+
+  SECTION("Set replaces all entries") {
+    REQUIRE_NOTHROW( journal.set("new") );
+    REQUIRE( journal.size() == 1 );
+    REQUIRE( journal.get() == "new" );
+
+    REQUIRE_NOTHROW( journal.set("") );
+    REQUIRE( journal.size() == 0 );
+  }
+
+  std::filesystem::remove(journal_db_path);
+}
+
+TEST_CASE("Journal migration", "[journal]") {
+  std::filesystem::remove(journal_db_path);
+  std::shared_ptr<srdp::Sql> db = std::make_shared<srdp::Sql>(journal_db_path);
+
+  // Tables of schema version 2
+  db->exec(R"(
+      CREATE TABLE projects (
+        uuid BLOB(16) NOT NULL PRIMARY KEY,
+        name VARCHAR(128) NOT NULL,
+        metadata TEXT,
+        owner TEXT,
+        ctime INTEGER,
+        journal TEXT
+      );
+      CREATE TABLE experiments (
+        uuid BLOB(16) NOT NULL PRIMARY KEY,
+        project BLOB(16) NOT NULL REFERENCES projects(uuid),
+        name VARCHAR(64) NOT NULL,
+        metadata TEXT,
+        owner TEXT,
+        ctime INTEGER,
+        journal TEXT,
+        locked BOOLEAN DEFAULT FALSE,
+        UNIQUE(project, name)
+      );
+  )");
+
+  srdp::Project project(db, "project", true);
+  srdp::Experiment exp(db, project, "experiment", true);
+  srdp::Experiment empty(db, project, "empty", true);
+
+  db->query("UPDATE projects SET journal = ?, owner = ? WHERE uuid = ?;",
+      srdp::Sql::vec_sql_t{std::string("project journal"), std::string("me"), srdp::bin_to_blob(project.uuid)});
+  db->query("UPDATE experiments SET journal = ? WHERE uuid = ?;",
+      srdp::Sql::vec_sql_t{std::string("experiment journal"), srdp::bin_to_blob(exp.uuid)});
+
+  REQUIRE_NOTHROW( srdp::Journal::migrate(*db) );
+
+  REQUIRE( project.get_journal() == "project journal" );
+  REQUIRE( project.journal().read()[0].author == "me" );
+  REQUIRE( exp.get_journal() == "experiment journal" );
+  REQUIRE( empty.journal().size() == 0 );
+
+  // Old columns are gone
+  REQUIRE_THROWS( db->query("SELECT journal FROM projects;") );
+
+  std::filesystem::remove(journal_db_path);
+}
@@ -2,15 +2,23 @@
 //
 // SPDX-License-Identifier: GPL-3.0-only
 
+#include <algorithm>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/uuid/string_generator.hpp>
 // #include <boost/program_options.hpp>
 #include <getopt.h>
+#include <csignal>
+#include <unistd.h>
 
 #include "srdp.h"
+#include "batch.h"
+#include "server.h"
+#include "watcher.h"
 #include "utils.h"
+#include "timings.h"
 
 // namespace po = boost::program_options;
 
@@ -24,6 +32,7 @@ struct options {
  std::string dir;
  std::string project;
  std::string experiment;
+ srdp::OutputWriter::format_t format = srdp::OutputWriter::format_t::human;
 };
 
 
@@ -33,9 +42,10 @@ namespace srdp {
   void print_help_init(){
     std::cout << "Usage: dp init [options] <project name>\n\n";
     std::cout << "Options:\n";
-    std::cout << "  --help, -h:   Show help.\n";
-    std::cout << "  --store, -s:  Locatation of data store (optional).\n";
-    std::cout << "                If not given, store will be created in project directory.\n";
+    std::cout << "  --help, -h:       Show help.\n";
+    std::cout << "  --store, -s:      Locatation of data store (optional).\n";
+    std::cout << "                    If not given, store will be created in project directory.\n";
+    std::cout << "  --gitignore, -g:  Also apply the rules of .gitignore files.\n";
     std::cout << "\n";
     std::cout << "Possitional options:\n";
     std::cout << "  project name:   name of project\n";
@@ -45,13 +55,15 @@ namespace srdp {
     const struct option long_options[] = {
       {"help", no_argument, 0, 'h'},
       {"store", required_argument, 0, 's'},
+      {"gitignore", no_argument, 0, 'g'},
       {0, 0, 0, 0}
     };
 
     std::string store_dir;
+    bool use_gitignore = false;
     int opt = 0;
 
-    while ((opt = getopt_long(argc, argv, "hs:", long_options, 0)) != -1) {
+    while ((opt = getopt_long(argc, argv, "hs:g", long_options, 0)) != -1) {
       switch (opt) {
         case 'h':
           srdp::print_help_init();
@@ -59,6 +71,9 @@ namespace srdp {
         case 's':
           store_dir = optarg;
           break;
+        case 'g':
+          use_gitignore = true;
+          break;
         default:
           throw std::invalid_argument("Unknown option");
       }
@@ -67,12 +82,12 @@ namespace srdp {
     if (argc > optind) {
       std::string target_dir = "./";
       if (!cmdopts.dir.empty()) target_dir = cmdopts.dir;
-      Srdp::init(target_dir, store_dir);
+      Srdp::init(target_dir, store_dir, use_gitignore);
       Srdp srdp(target_dir);
       Project prj = srdp.create_project(argv[optind]);
       prj.ctime = get_timestamp_now();
       prj.owner = Srdp::get_user_name();
-      prj.update();
+      srdp.update_project(prj);
       std::cout << "Created project " << prj.name << " (" << uuids::to_string(prj.uuid) << ")\n";
     } else {
       print_help_init();
@@ -81,12 +96,40 @@ namespace srdp {
     }
   }
 
+  /* Run a metadata command in a running dp serve.
+   *
+   * Only short commands are forwarded, the server answers one client
+   * at a time. File adds hash and copy, they always run in-process.
+   * Answers are printed as in-process runs would print them.
+   *
+   * Returns the answer of the server, or nothing if no server is
+   * running and the command has to be run in-process.
+   */
+  std::optional<std::string> forward_to_server(const options& cmdopts, const std::vector<std::string>& args){
+    // Timings and profiles are only meaningful in-process
+    if (Timings::enabled() || Sql::is_profiling()) return std::nullopt;
+
+    // Same project directory as in-process execution
+    const fs::path start = cmdopts.dir.empty() ? fs::current_path() : fs::absolute(cmdopts.dir);
+
+    auto result = Server::request(args, cmdopts.project, cmdopts.experiment, start);
+    if (!result) return std::nullopt;
+
+    if (!result->ok)
+      throw std::runtime_error(result->message);
+
+    return result->message;
+  }
+
   void print_help_project(){
     std::cout << "Usage: dp project [options] <command>\n\n";
     std::cout << "Options:\n";
     std::cout << "  --help, -h:     Show help.\n";
     std::cout << "  --message, -m:  Message for abstract/edit/append commands (optional).\n";
     std::cout << "                  If not given, $EDITOR will be opended.\n";
+    std::cout << "  --limit, -n:    Number of projects per page for list.\n";
+    std::cout << "  --after, -A:    Cursor printed by the previous page of list.\n";
+    std::cout << "  --sort, -S:     Sort list by ctime (default) or name.\n";
     std::cout << "\n";
     std::cout << "Commands:\n";
     std::cout << "  list, l:             List all projects in DB\n";
@@ -106,14 +149,18 @@ namespace srdp {
       {"help", no_argument, 0, 'h'},
       {"message", required_argument, 0, 'm'},
       {"all", required_argument, 0, 'a'},
+      {"limit", required_argument, 0, 'n'},
+      {"after", required_argument, 0, 'A'},
+      {"sort", required_argument, 0, 'S'},
       {0, 0, 0, 0}
     };
 
     std::string message;
+    PageOptions page;
     int opt = 0;
 
     bool print_all = false;
-    while ((opt = getopt_long(argc, argv, "ham:", long_options, 0)) != -1) {
+    while ((opt = getopt_long(argc, argv, "ham:n:A:S:", long_options, 0)) != -1) {
       switch (opt) {
         case 'h':
           srdp::print_help_project();
@@ -121,6 +168,15 @@ namespace srdp {
         case 'm':
           message = optarg;
           break;
+        case 'n':
+          page.limit = std::stoul(optarg);
+          break;
+        case 'A':
+          page.after = optarg;
+          break;
+        case 'S':
+          page.sort = PageOptions::string_to_sort(optarg);
+          break;
         case 'a':
           print_all = true;
           break;
@@ -132,17 +188,29 @@ namespace srdp {
     if (argc > optind) {
       const std::string cmd(argv[optind]);
 
+      // Without an editor the server can take it
+      if (!message.empty() && (cmd == "abstract" || cmd == "m" || cmd == "append" || cmd == "a")) {
+        if (forward_to_server(cmdopts, {"project", cmd, message})) return;
+      }
+
       std::string target_dir = "./";
       if (!cmdopts.dir.empty()) target_dir = cmdopts.dir;
       Srdp srdp(target_dir, true);
 
       if (cmd == "list" || cmd == "l") { // List all projects
-        std::vector<Project> plist = srdp.get_project().list();
+        OutputWriter out(cmdopts.format);
+        std::vector<Project> plist = srdp.get_project().list(page);
 
         for (auto prj : plist){
-          print_project(prj);
+          if (out.is_human())
+            print_project(prj);
+          else
+            write_project(out, prj);
         }
 
+        if (page.limit > 0 && plist.size() == page.limit)
+          write_cursor(out, plist.back().cursor(page.sort));
+
       } else if (cmd == "create" || cmd == "l") { // Create new project
         if (argc <= optind+1)
           throw std::runtime_error("No name given");
@@ -155,8 +223,8 @@ namespace srdp {
         if (!message.empty())
           prj.metadata = message;
 
-        prj.update();
-        srdp.config.set_project(prj.uuid);
+        srdp.update_project(prj);
+        srdp.get_config().set_project(prj.uuid);
 
         std::cout << "Created new project " << prj.name << " (" << uuids::to_string(prj.uuid) << ")\n";
       } else if (cmd == "info" || cmd == "i") { // Show current project
@@ -171,17 +239,17 @@ namespace srdp {
         }
 
         prj.metadata = message;
-        prj.update();
+        srdp.update_project(prj);
 
       } else if (cmd == "show" || cmd == "j"){ // Show the journal
         Project prj = srdp.open_project(cmdopts.project);
         std::cout << "project: " << prj.name << "\n";
-        std::cout << prj.get_journal() << "\n";
+        print_journal(prj.journal());
 
         if (print_all){
           for (auto e : srdp.get_experiment().list()) {
             std::cout << "experiment: " << e.name << "\n";
-            std::cout << e.get_journal() << "\n";
+            print_journal(e.journal());
           }
         }
 
@@ -203,7 +271,7 @@ namespace srdp {
           srdp.edit_text(composed_text);
         }
 
-        prj.append_journal("\n" + composed_text);
+        prj.journal().append("\n" + composed_text, Srdp::get_user_name());
 
       } else if (cmd == "set" || cmd == "s"){ // set active project
         if (argc <= optind+1)
@@ -213,7 +281,7 @@ namespace srdp {
         std::string project_id(argv[optind]);
 
         Project prj = srdp.open_project(argv[optind]);
-        srdp.config.set_project(prj.uuid);
+        srdp.get_config().set_project(prj.uuid);
 
         std::cout << "Changed active project to " << prj.name << " (" << uuids::to_string(prj.uuid) << ")\n";
 
@@ -222,21 +290,61 @@ namespace srdp {
 
       } else if (cmd == "assets" || cmd == "b"){
         Project prj = srdp.open_project(cmdopts.project);
-        Experiment exp = srdp.get_experiment(cmdopts.project);
-
-        std::cout << "Project:\n";
-        print_project(prj);
+        OutputWriter out(cmdopts.format);
+        Report::assets_visitor_t visitor;
+
+        // Experiment of the files being visited
+        std::optional<Experiment> current;
+
+        // Experiment records leave the file fields empty
+        auto write_asset = [&out, &current](const File* f, const std::string& creator) {
+          out.begin_record();
+          out.field("kind", f ? "file" : "experiment");
+          out.field("experiment", current->name);
+          out.uuid_field("experiment_uuid", bytes_view(current->uuid));
+          if (f) {
+            out.hex_field("hash", bytes_view(f->hash));
+            out.field("path", f->path);
+            out.field("role", f->role ? File::role_to_string(*f->role) : std::string());
+            out.field("size", int64_t(f->size));
+            if (creator.empty())
+              out.null_field("creator");
+            else
+              out.field("creator", creator);
+          } else {
+            out.null_field("hash");
+            out.null_field("path");
+            out.null_field("role");
+            out.null_field("size");
+            out.null_field("creator");
+          }
+          out.end_record();
+        };
 
-        for (auto e : exp.list()){
-          std::cout << "=> Experiment:\n";
-          print_experiment(e);
+        if (out.is_human()) {
+          std::cout << "Project:\n";
+          print_project(prj);
 
-          for (auto f: srdp.get_file(cmdopts.project, cmdopts.experiment).list()){
-          std::cout << "=> File:\n";
-            print_file_info(f);
-          }
+          visitor.experiment = [](const Experiment& e) {
+            std::cout << "=> Experiment:\n";
+            print_experiment(e);
+          };
+          visitor.file = [](const File& f, const std::string& creator) {
+            std::cout << "=> File:\n";
+            print_file_info(f, creator);
+          };
+        } else {
+          visitor.experiment = [&](const Experiment& e) {
+            current = e;
+            write_asset(nullptr, "");
+          };
+          visitor.file = [&](const File& f, const std::string& creator) {
+            write_asset(&f, creator);
+          };
         }
 
+        srdp.get_report().assets(prj, visitor);
+
       } else {
         srdp::print_help_project();
         std::cout << "\n";
@@ -255,6 +363,9 @@ namespace srdp {
     std::cout << "  --help, -h:     Show help.\n";
     std::cout << "  --message, -m:  Message for abstract/edit/append commands (optional).\n";
     std::cout << "                  If not given, $EDITOR will be opended.\n";
+    std::cout << "  --limit, -n:    Number of experiments per page for list.\n";
+    std::cout << "  --after, -A:    Cursor printed by the previous page of list.\n";
+    std::cout << "  --sort, -S:     Sort list by ctime (default) or name.\n";
     std::cout << "\n";
     std::cout << "Commands:\n";
     std::cout << "  list, l:             List all experiments in active project\n";
@@ -272,13 +383,17 @@ namespace srdp {
     const struct option long_options[] = {
       {"help", no_argument, 0, 'h'},
       {"message", required_argument, 0, 'm'},
+      {"limit", required_argument, 0, 'n'},
+      {"after", required_argument, 0, 'A'},
+      {"sort", required_argument, 0, 'S'},
       {0, 0, 0, 0}
     };
 
     std::string message;
+    PageOptions page;
     int opt = 0;
 
-    while ((opt = getopt_long(argc, argv, "hm:", long_options, 0)) != -1) {
+    while ((opt = getopt_long(argc, argv, "hm:n:A:S:", long_options, 0)) != -1) {
       switch (opt) {
         case 'h':
           srdp::print_help_experiment();
@@ -286,6 +401,15 @@ namespace srdp {
         case 'm':
           message = optarg;
           break;
+        case 'n':
+          page.limit = std::stoul(optarg);
+          break;
+        case 'A':
+          page.after = optarg;
+          break;
+        case 'S':
+          page.sort = PageOptions::string_to_sort(optarg);
+          break;
         default:
           throw std::invalid_argument("Unknown option");
       }
@@ -294,20 +418,41 @@ namespace srdp {
     if (argc > optind) {
       const std::string cmd(argv[optind]);
 
+      // Without an editor the server can take it
+      if (!message.empty() && (cmd == "abstract" || cmd == "m" || cmd == "append" || cmd == "a")) {
+        if (forward_to_server(cmdopts, {"experiment", cmd, message})) return;
+      }
+
+      if ((cmd == "set" || cmd == "s") && argc == optind+2) {
+        if (auto answer = forward_to_server(cmdopts, {"experiment", "set", argv[optind+1]})) {
+          std::cout << "Changed active experiment to " << answer->substr(answer->find(' ') + 1) << "\n";
+          return;
+        }
+      }
+
       std::string target_dir = "./";
       if (!cmdopts.dir.empty()) target_dir = cmdopts.dir;
       Srdp srdp(target_dir, true);
 
       if (cmd == "list" || cmd == "l") { // List all experiments in projects
-        auto elist = srdp.get_experiment(cmdopts.project).list();
-        auto prj = srdp.open_project(cmdopts.project);
+        OutputWriter out(cmdopts.format);
+        auto elist = srdp.get_experiment(cmdopts.project).list(page);
 
-        std::cout << "project: "  << prj.name << " (" << uuids::to_string(prj.uuid) << ")" << "\n\n";
+        if (out.is_human()) {
+          auto prj = srdp.open_project(cmdopts.project);
+          std::cout << "project: "  << prj.name << " (" << uuids::to_string(prj.uuid) << ")" << "\n\n";
+        }
 
         for (auto exp : elist){
-          print_experiment(exp);
+          if (out.is_human())
+            print_experiment(exp);
+          else
+            write_experiment(out, exp);
         }
 
+        if (page.limit > 0 && elist.size() == page.limit)
+          write_cursor(out, elist.back().cursor(page.sort));
+
       } else if (cmd == "create" || cmd == "c") { // Create new experiment
         if (argc <= optind+1)
           throw std::runtime_error("No name given");
@@ -320,8 +465,8 @@ namespace srdp {
         if (!message.empty())
           exp.metadata = message;
 
-        exp.update();
-        srdp.config.set_experiment(exp.uuid);
+        srdp.update_experiment(exp);
+        srdp.get_config().set_experiment(exp.uuid);
 
         std::cout << "Created new experiment " << exp.name << " (" << uuids::to_string(exp.uuid) << ")\n";
 
@@ -342,11 +487,11 @@ namespace srdp {
         }
 
         exp.metadata = message;
-        exp.update();
+        srdp.update_experiment(exp);
 
       } else if (cmd == "show" || cmd == "j"){ // Show the journal
         Experiment exp = srdp.open_experiment(cmdopts.project, cmdopts.experiment);
-        std::cout << exp.get_journal() << "\n";
+        print_journal(exp.journal());
 
       } else if (cmd == "edit" || cmd == "e"){ // Edit the journal
         Experiment exp = srdp.open_experiment(cmdopts.project, cmdopts.experiment);
@@ -366,7 +511,7 @@ namespace srdp {
           srdp.edit_text(composed_text);
         }
 
-        exp.append_journal("\n" + composed_text);
+        exp.journal().append("\n" + composed_text, Srdp::get_user_name());
 
       } else if (cmd == "set" || cmd == "s"){ // set active experiment
         if (argc <= optind+1)
@@ -377,7 +522,7 @@ namespace srdp {
 
         auto exp = srdp.open_experiment(argv[optind], cmdopts.project);
 
-        srdp.config.set_experiment(exp.uuid);
+        srdp.get_config().set_experiment(exp.uuid);
 
         std::cout << "Changed active experiment to " << exp.name << " (" << uuids::to_string(exp.uuid) << ")\n";
       } else {
@@ -398,6 +543,9 @@ namespace srdp {
     std::cout << "  --help, -h:     Show help.\n";
     std::cout << "  --message, -m:  Message for abstract/edit/append commands (optional).\n";
     std::cout << "                  If not given, $EDITOR will be opended.\n";
+    std::cout << "  --limit, -n:    Number of files per page for list.\n";
+    std::cout << "  --after, -A:    Cursor printed by the previous page of list.\n";
+    std::cout << "  --sort, -S:     Sort list by role (default), path, or hash.\n";
     std::cout << "\n";
     std::cout << "Commands:\n";
     std::cout << "  list, l:                            list all files in active experiment\n";
@@ -410,17 +558,30 @@ namespace srdp {
   void command_file(int argc, char *argv[], const options& cmdopts){
     const struct option long_options[] = {
       {"help", no_argument, 0, 'h'},
+      {"limit", required_argument, 0, 'n'},
+      {"after", required_argument, 0, 'A'},
+      {"sort", required_argument, 0, 'S'},
       {0, 0, 0, 0}
     };
 
     std::string message;
+    PageOptions page;
     int opt = 0;
 
-    while ((opt = getopt_long(argc, argv, "hm:", long_options, 0)) != -1) {
+    while ((opt = getopt_long(argc, argv, "hm:n:A:S:", long_options, 0)) != -1) {
       switch (opt) {
         case 'h':
           srdp::print_help_file();
           return;
+        case 'n':
+          page.limit = std::stoul(optarg);
+          break;
+        case 'A':
+          page.after = optarg;
+          break;
+        case 'S':
+          page.sort = PageOptions::string_to_sort(optarg);
+          break;
         default:
           throw std::invalid_argument("Unknown option");
       }
@@ -429,15 +590,43 @@ namespace srdp {
     if (argc > optind) {
       const std::string cmd(argv[optind]);
 
+      if ((cmd == "unlink" || cmd == "u") && argc == optind+2) {
+        if (auto answer = forward_to_server(cmdopts, {"file", "unlink", argv[optind+1]})) {
+          std::cout << *answer << "\n";
+          return;
+        }
+      }
+
       std::string target_dir = "./";
       if (!cmdopts.dir.empty()) target_dir = cmdopts.dir;
       Srdp srdp(target_dir, true);
 
       if (cmd == "list" || cmd == "l") { // List all files in experiment
-        auto flist = srdp.get_file(cmdopts.project, cmdopts.experiment).list();
+        OutputWriter out(cmdopts.format);
+        auto file = srdp.get_file(cmdopts.project, cmdopts.experiment);
+
+        if (out.is_human()) {
+          auto flist = file.list(page);
 
-        for (auto f : flist){
-          print_file_info(f);
+          for (auto f : flist){
+            print_file_info(f);
+          }
+
+          if (page.limit > 0 && flist.size() == page.limit)
+            write_cursor(out, flist.back().cursor(page.sort));
+        } else {
+          // Serialize straight from the rows
+          size_t count = 0;
+          std::string cursor;
+
+          file.scan(page, std::optional<File::role_t>(), [&](const File::view_t& f) {
+            write_file(out, f);
+            if (page.limit > 0 && ++count == page.limit)
+              cursor = File::cursor(f, page.sort);
+          });
+
+          if (!cursor.empty())
+            write_cursor(out, cursor);
         }
 
       } else if (cmd == "add" || cmd == "a") { // add file to experiment
@@ -452,17 +641,13 @@ namespace srdp {
 
         optind++;
 
-        while (optind < argc) {
-          fs::path path = argv[optind];
-
-          File file = srdp.add_file(cmdopts.project, cmdopts.experiment, path, role);
-
-          std::cout << "Added " <<
-            File::role_to_string(*file.role) << " "
-            << path << " (" << scas::Hash::convert_hash_to_string(file.hash) <<")\n";
-
-          optind++;
-        }
+        std::vector<fs::path> paths(argv + optind, argv + argc);
+        // Printed as added, also if a later file fails
+        srdp.add_files(srdp.open_experiment(cmdopts.experiment, cmdopts.project), paths, role,
+            [](const fs::path& path, const File& file) {
+              std::cout << "Added " << File::role_to_string(*file.role) << " "
+                << path << " (" << scas::Hash::convert_hash_to_string(file.hash) << ")\n";
+            });
 
       } else if (cmd == "unlink" || cmd == "u") { // remove file entry
         if (argc <= optind+1)
@@ -534,6 +719,102 @@ namespace srdp {
 
   }
 
+  void print_help_search(){
+    std::cout << "Usage: dp search [options] <query>\n\n";
+    std::cout << "Search names, abstracts, journals, file names, file metadata, and paths.\n";
+    std::cout << "Every word must match, a trailing '*' matches a prefix.\n";
+    std::cout << "Use the global --project/--experiment options to restrict the search.\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --help, -h:   Show help.\n";
+    std::cout << "  --role, -r:   Only files with role input|output|note|program|nixpath.\n";
+    std::cout << "  --limit, -n:  Maximum number of results (default: 20).\n";
+    std::cout << "  --raw, -q:    Pass the query unchanged in SQLite FTS5 syntax.\n";
+  }
+
+  void command_search(int argc, char *argv[], const options& cmdopts){
+    const struct option long_options[] = {
+      {"help", no_argument, 0, 'h'},
+      {"role", required_argument, 0, 'r'},
+      {"limit", required_argument, 0, 'n'},
+      {"raw", no_argument, 0, 'q'},
+      {0, 0, 0, 0}
+    };
+
+    Search::options_t search_opts;
+    int opt = 0;
+
+    while ((opt = getopt_long(argc, argv, "hr:n:q", long_options, 0)) != -1) {
+      switch (opt) {
+        case 'h':
+          srdp::print_help_search();
+          return;
+        case 'r':
+          search_opts.role = File::string_to_role(optarg);
+          if (search_opts.role == File::role_t::none)
+            throw std::runtime_error("Invalid role");
+          break;
+        case 'n':
+          search_opts.limit = std::stoul(optarg);
+          break;
+        case 'q':
+          search_opts.raw = true;
+          break;
+        default:
+          throw std::invalid_argument("Unknown option");
+      }
+    }
+
+    for (; optind < argc; optind++) {
+      if (!search_opts.query.empty()) search_opts.query += " ";
+      search_opts.query += argv[optind];
+    }
+
+    if (search_opts.query.empty()) {
+      srdp::print_help_search();
+      std::cout << "\n";
+      throw std::invalid_argument("No query given");
+    }
+
+    std::string target_dir = "./";
+    if (!cmdopts.dir.empty()) target_dir = cmdopts.dir;
+    Srdp srdp(target_dir, true);
+
+    if (!cmdopts.project.empty())
+      search_opts.project = srdp.open_project(cmdopts.project).uuid;
+    if (!cmdopts.experiment.empty())
+      search_opts.experiment = srdp.open_experiment(cmdopts.experiment, cmdopts.project).uuid;
+
+    OutputWriter out(cmdopts.format);
+
+    for (const auto& r : srdp.get_search().query(search_opts)) {
+      if (!out.is_human()) {
+        out.begin_record();
+        out.field("kind", Search::kind_to_string(r.kind));
+        out.field("project", r.project);
+        out.field("experiment", r.experiment);
+        out.field("name", r.name);
+        if (r.hash)
+          out.hex_field("hash", bytes_view(*r.hash));
+        else
+          out.null_field("hash");
+        out.field("snippet", r.snippet);
+        out.end_record();
+        continue;
+      }
+
+      std::cout << Search::kind_to_string(r.kind) << ":";
+      if (r.project) std::cout << " " << *r.project;
+      if (r.experiment) std::cout << "/" << *r.experiment;
+      if (r.name && r.kind != Search::kind_t::project && r.kind != Search::kind_t::experiment)
+        std::cout << " " << *r.name;
+      if (r.hash) std::cout << " (" << scas::Hash::convert_hash_to_string(*r.hash) << ")";
+
+      std::string snippet = r.snippet;
+      std::replace(snippet.begin(), snippet.end(), '\n', ' ');
+      std::cout << "\n  " << snippet << "\n";
+    }
+  }
+
   void print_help(){
     std::cout << srdp::name + ": the simple resarch data pipeline tool\n\n";
     std::cout << "Usage: " + basename + " [options] <sub command>\n\n";
@@ -544,6 +825,11 @@ namespace srdp {
     std::cout << "  --project, -d:     Select project project by name.\n";
     std::cout << "  --experiment, -e:  Select project experiment by name.\n";
     std::cout << "  --version, -v:     Show program version.\n";
+    std::cout << "  --format, -f:      Output format of listings: human (default), jsonl, or tsv.\n";
+    std::cout << "  --timings, -t:     Print where the time went to stderr at exit.\n";
+    std::cout << "  --profile-sql[=N], -P[N]:\n";
+    std::cout << "                     Print the N (default 20) most expensive SQL statements\n";
+    std::cout << "                     to stderr at exit.\n";
     std::cout << "\n";
     std::cout << "Possible sub commands:\n";
     std::cout << "  init             Initialize project directory.\n";
@@ -551,32 +837,391 @@ namespace srdp {
     std::cout << "  experiment, e    Manage experiment settings.\n";
     std::cout << "  file, f          Manage file handling.\n";
     std::cout << "  verify, v        Verfify store and database.\n";
+    std::cout << "  status, s        Show tracked and untracked files.\n";
+    std::cout << "  search           Full-text search in projects, experiments, and files.\n";
+    std::cout << "  batch            Run many commands from a file or stdin.\n";
+    std::cout << "  watch            Keep the workspace status up to date in the background.\n";
+    std::cout << "  serve            Answer metadata commands from a background process.\n";
+    std::cout << "\n";
+    std::cout << "Environment:\n";
+    std::cout << "  SRDP_TOP_LEVEL_DIR  Canonical path of the project directory. Saves the\n";
+    std::cout << "                      search for it when running many commands inside it.\n";
+    std::cout << "  SRDP_TIMINGS        If set (not 0), same as --timings. Also applies to\n";
+    std::cout << "                      other programs using libsrdp.\n";
+  }
+
+  void print_help_verify(){
+    std::cout << "Usage: dp verify [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --help, -h:         Show help.\n";
+    std::cout << "  --incremental, -i:  Only check file mappings that are new or\n";
+    std::cout << "                      have changed since the last run.\n";
+    std::cout << "  --max-age, -a:      Re-check entries verified longer ago than\n";
+    std::cout << "                      <n>[s|m|h|d] (default unit: days).\n";
+    std::cout << "  --sample, -s:       Deep check a size weighted random sample of\n";
+    std::cout << "                      <fraction> (e.g. 0.01, 1%) or <count> files.\n";
+    std::cout << "  --seed, -r:         Random seed for --sample.\n";
+    std::cout << "  --jobs, -j:         Number of threads for --sample.\n";
+  }
+
+  ctime_t parse_age(const std::string& age){
+    size_t pos = 0;
+    ctime_t value = std::stoll(age, &pos);
+
+    if (value < 0)
+      throw std::invalid_argument("Negative age given");
+
+    const std::string unit = age.substr(pos);
+    if (unit.empty() || unit == "d") return value * 86400;
+    else if (unit == "h") return value * 3600;
+    else if (unit == "m") return value * 60;
+    else if (unit == "s") return value;
+    else
+      throw std::invalid_argument("Invalid age unit: " + unit);
+  }
+
+  void parse_sample(const std::string& sample, VerifyOptions& verify_opts){
+    size_t pos = 0;
+
+    if (sample.find_first_of(".%") != std::string::npos) {
+      double fraction = std::stod(sample, &pos);
+      if (sample.substr(pos) == "%") fraction /= 100;
+      else if (pos != sample.size())
+        throw std::invalid_argument("Invalid sample size: " + sample);
+
+      if (fraction <= 0 || fraction > 1)
+        throw std::invalid_argument("Sample fraction must be in (0, 1]");
+
+      verify_opts.sample_fraction = fraction;
+    } else {
+      long long count = std::stoll(sample, &pos);
+      if (pos != sample.size() || count <= 0)
+        throw std::invalid_argument("Invalid sample size: " + sample);
+
+      verify_opts.sample_count = count;
+    }
   }
 
   void command_verify(int argc, char *argv[], const options& cmdopts){
+    const struct option long_options[] = {
+      {"help", no_argument, 0, 'h'},
+      {"incremental", no_argument, 0, 'i'},
+      {"max-age", required_argument, 0, 'a'},
+      {"sample", required_argument, 0, 's'},
+      {"seed", required_argument, 0, 'r'},
+      {"jobs", required_argument, 0, 'j'},
+      {0, 0, 0, 0}
+    };
+
+    VerifyOptions verify_opts;
+    int opt = 0;
+
+    while ((opt = getopt_long(argc, argv, "hia:s:r:j:", long_options, 0)) != -1) {
+      switch (opt) {
+        case 'h':
+          srdp::print_help_verify();
+          return;
+        case 'i':
+          verify_opts.incremental = true;
+          break;
+        case 'a':
+          verify_opts.max_age = parse_age(optarg);
+          break;
+        case 's':
+          parse_sample(optarg, verify_opts);
+          break;
+        case 'r':
+          verify_opts.sample_seed = std::stoull(optarg);
+          break;
+        case 'j':
+          verify_opts.jobs = std::stoul(optarg);
+          break;
+        default:
+          throw std::invalid_argument("Unknown option");
+      }
+    }
+
     std::string target_dir = "./";
     if (!cmdopts.dir.empty()) target_dir = cmdopts.dir;
     Srdp srdp(target_dir, true);
 
-    srdp.verify();
+    srdp.verify(verify_opts);
+  }
+
+  void print_help_status(){
+    std::cout << "Usage: dp status [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --help, -h:      Show help.\n";
+    std::cout << "  --jobs, -j:      Number of threads used to scan the directory tree.\n";
+    std::cout << "  --no-index, -n:  Do not use the workspace index, rescan all directories.\n";
+    std::cout << "  --no-watch, -w:  Do not ask a running watcher (dp watch), scan the directories.\n";
   }
 
   void command_status(int argc, char *argv[], const options& cmdopts){
+    const struct option long_options[] = {
+      {"help", no_argument, 0, 'h'},
+      {"jobs", required_argument, 0, 'j'},
+      {"no-index", no_argument, 0, 'n'},
+      {"no-watch", no_argument, 0, 'w'},
+      {0, 0, 0, 0}
+    };
+
+    unsigned jobs = 0;
+    bool use_index = true;
+    bool use_watcher = true;
+    int opt = 0;
+
+    while ((opt = getopt_long(argc, argv, "hj:nw", long_options, 0)) != -1) {
+      switch (opt) {
+        case 'h':
+          srdp::print_help_status();
+          return;
+        case 'j':
+          jobs = std::stoul(optarg);
+          break;
+        case 'n':
+          use_index = false;
+          break;
+        case 'w':
+          use_watcher = false;
+          break;
+        default:
+          throw std::invalid_argument("Unknown option");
+      }
+    }
+
     std::string target_dir = "./";
     if (!cmdopts.dir.empty()) target_dir = cmdopts.dir;
     Srdp srdp(target_dir, true);
 
-    auto files = srdp.get_file_list();
+    // Ask a running watcher first, fall back to scanning
+    std::optional<std::list<Srdp::DirEntry>> watched;
+    if (use_watcher) watched = Watcher::query(srdp);
+
+    auto files = watched ? std::move(*watched) : srdp.get_file_list(true, jobs, use_index);
 
-    std::for_each(files.cbegin(), files.cend(), [&srdp](const Srdp::DirEntry& e) {
-      if (e.is_in_store) {
+    OutputWriter out(cmdopts.format);
+
+    std::for_each(files.cbegin(), files.cend(), [&srdp, &out](const Srdp::DirEntry& e) {
+      if (!out.is_human()) {
+        out.begin_record();
+        out.field("state", e.is_in_store ? "tracked" : "untracked");
+        out.bool_field("active", e.is_active);
+        out.field("path", fmt_relative_path(e.file, srdp.get_top_level_dir()));
+        out.end_record();
+      } else if (e.is_in_store) {
         std::cout << "tracked: " << fmt_relative_path(e.file, srdp.get_top_level_dir());
         if (e.is_active) std::cout << " (active)";
-        std::cout << std::endl;
+        std::cout << "\n";
       } else
-        std::cout << "untracked: " << fmt_relative_path(e.file, srdp.get_top_level_dir()) << std::endl;
+        std::cout << "untracked: " << fmt_relative_path(e.file, srdp.get_top_level_dir()) << "\n";
     });
   }
+
+  void print_help_batch(){
+    std::cout << "Usage: dp batch [options] [file]\n\n";
+    std::cout << "Run commands from file or stdin, one per line, in one process.\n";
+    std::cout << "A line holds words (quoted as in a shell) or a JSON array of strings.\n";
+    std::cout << "Failing commands are rolled back and reported, the batch continues.\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --help, -h:        Show help.\n";
+    std::cout << "  --batch-size, -b:  Commands per transaction (default: 1000).\n";
+    std::cout << "                     Results are printed when their transaction is committed.\n";
+    std::cout << "\n";
+    std::cout << "Commands:\n";
+    std::cout << "  file add <role> <path> [path [...]]\n";
+    std::cout << "  file unlink <path|hash>\n";
+    std::cout << "  experiment create <name>\n";
+    std::cout << "  experiment set <name|uuid>\n";
+    std::cout << "  project|experiment abstract <text>\n";
+    std::cout << "  project|experiment append <text>\n";
+  }
+
+  void command_batch(int argc, char *argv[], const options& cmdopts){
+    const struct option long_options[] = {
+      {"help", no_argument, 0, 'h'},
+      {"batch-size", required_argument, 0, 'b'},
+      {0, 0, 0, 0}
+    };
+
+    size_t batch_size = 1000;
+    int opt = 0;
+
+    while ((opt = getopt_long(argc, argv, "hb:", long_options, 0)) != -1) {
+      switch (opt) {
+        case 'h':
+          srdp::print_help_batch();
+          return;
+        case 'b':
+          batch_size = std::stoul(optarg);
+          break;
+        default:
+          throw std::invalid_argument("Unknown option");
+      }
+    }
+
+    std::ifstream file;
+    if (argc > optind && std::string(argv[optind]) != "-") {
+      file.open(argv[optind]);
+      if (!file)
+        throw std::runtime_error("Can not open " + std::string(argv[optind]));
+    }
+    std::istream& in = file.is_open() ? file : std::cin;
+
+    std::string target_dir = "./";
+    if (!cmdopts.dir.empty()) target_dir = cmdopts.dir;
+    Srdp srdp(target_dir, false);
+
+    Batch batch(srdp, batch_size, cmdopts.project, cmdopts.experiment);
+    OutputWriter out(cmdopts.format == OutputWriter::format_t::human ? OutputWriter::format_t::tsv : cmdopts.format);
+
+    const size_t failed = batch.run(in, [&out](const Batch::result_t& r) {
+          if (out.get_format() == OutputWriter::format_t::jsonl) {
+            out.begin_record();
+            out.field("line", int64_t(r.line));
+            out.bool_field("ok", r.ok);
+            out.field("message", r.message);
+            out.end_record();
+          } else {
+            out.begin_record();
+            out.field("line", int64_t(r.line));
+            out.field("result", r.ok ? "ok" : "error");
+            out.field("message", r.message);
+            out.end_record();
+          }
+        },
+        [&out]() { out.flush(); });
+
+    if (failed > 0)
+      throw std::runtime_error(std::to_string(failed) + " command(s) failed");
+  }
+
+  Watcher* active_watcher = nullptr;
+
+  void stop_watcher(int){
+    if (active_watcher) active_watcher->stop();
+  }
+
+  void print_help_watch(){
+    std::cout << "Usage: dp watch [options]\n\n";
+    std::cout << "Watch the project directory with inotify and serve the\n";
+    std::cout << "workspace status to dp status. Restart after changing the ignore file.\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --help, -h:    Show help.\n";
+    std::cout << "  --detach, -D:  Run in the background.\n";
+  }
+
+  void command_watch(int argc, char *argv[], const options& cmdopts){
+    const struct option long_options[] = {
+      {"help", no_argument, 0, 'h'},
+      {"detach", no_argument, 0, 'D'},
+      {0, 0, 0, 0}
+    };
+
+    bool detach = false;
+    int opt = 0;
+
+    while ((opt = getopt_long(argc, argv, "hD", long_options, 0)) != -1) {
+      switch (opt) {
+        case 'h':
+          srdp::print_help_watch();
+          return;
+        case 'D':
+          detach = true;
+          break;
+        default:
+          throw std::invalid_argument("Unknown option");
+      }
+    }
+
+    std::string target_dir = "./";
+    if (!cmdopts.dir.empty()) target_dir = cmdopts.dir;
+    Srdp srdp(target_dir, true);
+
+    Watcher watcher(srdp);
+    std::cout << "Watching " << watcher.size() << " directories\n";
+
+    if (detach) {
+      std::cout.flush();
+      if (daemon(1, 0) != 0)
+        throw std::system_error(errno, std::system_category(), "Can not detach");
+    }
+
+    active_watcher = &watcher;
+    struct sigaction sa{};
+    sa.sa_handler = stop_watcher;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    watcher.run();
+    active_watcher = nullptr;
+  }
+
+  Server* active_server = nullptr;
+
+  void stop_server(int){
+    if (active_server) active_server->stop();
+  }
+
+  void print_help_serve(){
+    std::cout << "Usage: dp serve [options]\n\n";
+    std::cout << "Keep the project database open and answer the commands of dp batch\n";
+    std::cout << "over a Unix socket in the config directory. While it is running,\n";
+    std::cout << "dp file add/unlink, dp experiment set, and abstract/append with\n";
+    std::cout << "--message are sent to it instead of being run in-process.\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --help, -h:    Show help.\n";
+    std::cout << "  --detach, -D:  Run in the background.\n";
+  }
+
+  void command_serve(int argc, char *argv[], const options& cmdopts){
+    const struct option long_options[] = {
+      {"help", no_argument, 0, 'h'},
+      {"detach", no_argument, 0, 'D'},
+      {0, 0, 0, 0}
+    };
+
+    bool detach = false;
+    int opt = 0;
+
+    while ((opt = getopt_long(argc, argv, "hD", long_options, 0)) != -1) {
+      switch (opt) {
+        case 'h':
+          srdp::print_help_serve();
+          return;
+        case 'D':
+          detach = true;
+          break;
+        default:
+          throw std::invalid_argument("Unknown option");
+      }
+    }
+
+    std::string target_dir = "./";
+    if (!cmdopts.dir.empty()) target_dir = cmdopts.dir;
+    Srdp srdp(target_dir);
+
+    // Paths of requests are absolute or relative to the top level directory
+    fs::current_path(srdp.get_top_level_dir());
+
+    Server server(srdp);
+    std::cout << "Serving " << (srdp.get_cfg_dir() / Server::socket_name).string() << "\n";
+
+    if (detach) {
+      std::cout.flush();
+      if (daemon(1, 0) != 0)
+        throw std::system_error(errno, std::system_category(), "Can not detach");
+    }
+
+    active_server = &server;
+    struct sigaction sa{};
+    sa.sa_handler = stop_server;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    server.run();
+    active_server = nullptr;
+  }
 }
 
 /**
@@ -591,6 +1236,9 @@ int main(int argc, char* argv[]){
       {"project", required_argument, 0, 'p'},
       {"experiment", required_argument, 0, 'e'},
       {"version", no_argument, 0, 'v'},
+      {"format", required_argument, 0, 'f'},
+      {"timings", no_argument, 0, 't'},
+      {"profile-sql", optional_argument, 0, 'P'},
       {0, 0, 0, 0}
     };
 
@@ -598,7 +1246,7 @@ int main(int argc, char* argv[]){
 
     options command_opts;
     int opt=0;
-    while ((opt = getopt_long(argc, argv, "+hd:p:e:v", long_options, 0)) != -1) {
+    while ((opt = getopt_long(argc, argv, "+hd:p:e:vf:tP::", long_options, 0)) != -1) {
       switch (opt) {
         case 'h':
           srdp::print_help();
@@ -615,6 +1263,24 @@ int main(int argc, char* argv[]){
         case 'v':
           std::cout << srdp::name + " " + srdp::version << "\n";
           return EXIT_SUCCESS;
+        case 'f':
+          command_opts.format = srdp::OutputWriter::string_to_format(optarg);
+          break;
+        case 't':
+          srdp::Timings::enable();
+          break;
+        case 'P': {
+          size_t top = 20;
+          if (optarg) {
+            const std::string value(optarg);
+            const bool is_number = !value.empty() && value.size() < 10
+              && value.find_first_not_of("0123456789") == std::string::npos;
+            if (!is_number || (top = std::stoul(value)) == 0)
+              throw std::invalid_argument("--profile-sql: expected a positive number of statements, got '" + value + "'");
+          }
+          srdp::Sql::enable_profiler(top);
+          break;
+        }
         default:
           throw std::invalid_argument("Unknown option");
       }
@@ -626,6 +1292,8 @@ int main(int argc, char* argv[]){
       char **new_argv = argv + optind;
       optind = 0;
 
+      srdp::Timings::Span span(("dp " + cmd).c_str());
+
       if (cmd == "init"){
         srdp::command_init(new_argc, new_argv, command_opts);
       } else if (cmd == "p" || cmd == "project") {
@@ -638,6 +1306,14 @@ int main(int argc, char* argv[]){
         srdp::command_verify(new_argc, new_argv, command_opts);
       } else if (cmd == "s" || cmd == "status") {
         srdp::command_status(new_argc, new_argv, command_opts);
+      } else if (cmd == "search") {
+        srdp::command_search(new_argc, new_argv, command_opts);
+      } else if (cmd == "batch") {
+        srdp::command_batch(new_argc, new_argv, command_opts);
+      } else if (cmd == "watch") {
+        srdp::command_watch(new_argc, new_argv, command_opts);
+      } else if (cmd == "serve") {
+        srdp::command_serve(new_argc, new_argv, command_opts);
       } else
         throw std::invalid_argument("Unknown command");
     } else {
@@ -0,0 +1,201 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include "output.h"
+
+namespace srdp {
+
+  static const char hex_digits[] = "0123456789abcdef";
+
+  OutputWriter::format_t OutputWriter::string_to_format(const std::string& format){
+    if (format == "human") return format_t::human;
+    else if (format == "jsonl") return format_t::jsonl;
+    else if (format == "tsv") return format_t::tsv;
+    else
+      throw std::invalid_argument("Invalid output format: " + format);
+  }
+
+  OutputWriter::OutputWriter(format_t format_in, int fd_in, size_t block_size_in) :
+    format(format_in), fd(fd_in), block_size(block_size_in)
+  {
+    buffer.reserve(2 * block_size);
+  }
+
+  OutputWriter::~OutputWriter(){
+    try {
+      flush();
+    } catch (std::exception&) {
+      // Nothing sensible left to do, e.g. closed pipe
+    }
+  }
+
+  void OutputWriter::write_buffer(){
+    const char* data = buffer.data();
+    size_t left = buffer.size();
+
+    while (left > 0) {
+      const ssize_t n = ::write(fd, data, left);
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        buffer.clear();
+        throw std::runtime_error("Can not write output: " + std::string(std::strerror(errno)));
+      }
+      data += n;
+      left -= n;
+    }
+
+    buffer.clear();
+  }
+
+  void OutputWriter::flush(){
+    if (!buffer.empty()) write_buffer();
+  }
+
+  void OutputWriter::begin_record(){
+    first_field = true;
+    record_start = buffer.size();
+
+    if (format == format_t::jsonl) buffer += '{';
+  }
+
+  void OutputWriter::end_record(){
+    if (format == format_t::jsonl) buffer += '}';
+    buffer += '\n';
+
+    // The header is only known after the first record
+    if (format == format_t::tsv && !header_done) {
+      header += '\n';
+      buffer.insert(record_start, header);
+      header_done = true;
+    }
+
+    if (buffer.size() >= block_size) write_buffer();
+  }
+
+  void OutputWriter::key(std::string_view name){
+    switch (format) {
+      case format_t::jsonl:
+        if (!first_field) buffer += ',';
+        buffer += '"';
+        append_escaped(name);
+        buffer += "\":";
+        break;
+      case format_t::tsv:
+        if (!first_field) buffer += '\t';
+        if (!header_done) {
+          if (!first_field) header += '\t';
+          header.append(name);
+        }
+        break;
+      case format_t::human:
+        buffer.append(name);
+        buffer += ": ";
+        break;
+    }
+
+    first_field = false;
+  }
+
+  void OutputWriter::append_escaped(std::string_view value){
+    // Copy runs of plain characters in one go
+    size_t run = 0;
+
+    for (size_t i=0; i < value.size(); i++) {
+      const unsigned char c = value[i];
+      const char* esc = nullptr;
+      char code[7];
+
+      if (format == format_t::jsonl) {
+        if (c == '"') esc = "\\\"";
+        else if (c == '\\') esc = "\\\\";
+        else if (c == '\n') esc = "\\n";
+        else if (c == '\t') esc = "\\t";
+        else if (c == '\r') esc = "\\r";
+        else if (c < 0x20) {
+          std::memcpy(code, "\\u00", 4);
+          code[4] = hex_digits[c >> 4];
+          code[5] = hex_digits[c & 15];
+          code[6] = '\0';
+          esc = code;
+        }
+      } else if (format == format_t::tsv) {
+        if (c == '\\') esc = "\\\\";
+        else if (c == '\n') esc = "\\n";
+        else if (c == '\t') esc = "\\t";
+        else if (c == '\r') esc = "\\r";
+      }
+
+      if (esc) {
+        buffer.append(value.data() + run, i - run);
+        buffer.append(esc);
+        run = i + 1;
+      }
+    }
+
+    buffer.append(value.data() + run, value.size() - run);
+  }
+
+  void OutputWriter::field(std::string_view name, std::string_view value){
+    key(name);
+
+    if (format == format_t::jsonl) buffer += '"';
+    append_escaped(value);
+    if (format == format_t::jsonl) buffer += '"';
+    if (format == format_t::human) buffer += '\n';
+  }
+
+  void OutputWriter::field(std::string_view name, int64_t value){
+    key(name);
+
+    char digits[24];
+    const int n = std::snprintf(digits, sizeof(digits), "%lld", static_cast<long long>(value));
+    buffer.append(digits, n);
+    if (format == format_t::human) buffer += '\n';
+  }
+
+  void OutputWriter::null_field(std::string_view name){
+    key(name);
+
+    if (format == format_t::jsonl) buffer += "null";
+    if (format == format_t::human) buffer += '\n';
+  }
+
+  void OutputWriter::bool_field(std::string_view name, bool value){
+    key(name);
+
+    buffer += value ? "true" : "false";
+    if (format == format_t::human) buffer += '\n';
+  }
+
+  void OutputWriter::hex_field(std::string_view name, std::string_view bytes){
+    key(name);
+
+    if (format == format_t::jsonl) buffer += '"';
+    for (unsigned char c : bytes) {
+      buffer += hex_digits[c >> 4];
+      buffer += hex_digits[c & 15];
+    }
+    if (format == format_t::jsonl) buffer += '"';
+    if (format == format_t::human) buffer += '\n';
+  }
+
+  void OutputWriter::uuid_field(std::string_view name, std::string_view bytes){
+    key(name);
+
+    if (format == format_t::jsonl) buffer += '"';
+    for (size_t i=0; i < bytes.size(); i++) {
+      if (i == 4 || i == 6 || i == 8 || i == 10) buffer += '-';
+      const unsigned char c = bytes[i];
+      buffer += hex_digits[c >> 4];
+      buffer += hex_digits[c & 15];
+    }
+    if (format == format_t::jsonl) buffer += '"';
+    if (format == format_t::human) buffer += '\n';
+  }
+}
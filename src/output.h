@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_OUTPUT_H
+#define SRDP_OUTPUT_H
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <unistd.h>
+
+namespace srdp {
+
+  /**
+   * Buffered writer for machine readable listings.
+   *
+   * Records are written as JSON Lines or as TSV with a header line
+   * taken from the keys of the first record. Fields are escaped while
+   * appending to the buffer, which is written in large blocks.
+   */
+  class OutputWriter {
+    public:
+      enum class format_t {
+        human,
+        jsonl,
+        tsv
+      };
+
+    private:
+      format_t format;
+      int fd;
+      size_t block_size;
+      std::string buffer;
+
+      bool first_field = true;
+      bool header_done = false;
+      size_t record_start = 0;
+      std::string header;
+
+      void key(std::string_view name);
+      void append_escaped(std::string_view value);
+      void write_buffer();
+
+    public:
+      static format_t string_to_format(const std::string& format);
+
+      OutputWriter(format_t format, int fd = STDOUT_FILENO, size_t block_size = 1 << 16);
+      ~OutputWriter();
+
+      OutputWriter(const OutputWriter&) = delete;
+      OutputWriter& operator=(const OutputWriter&) = delete;
+
+      format_t get_format() const { return format; }
+      bool is_human() const { return format == format_t::human; }
+
+      void begin_record();
+      void end_record();
+
+      void field(std::string_view name, std::string_view value);
+      void field(std::string_view name, const char* value) { field(name, std::string_view(value)); }
+      void field(std::string_view name, int64_t value);
+      void null_field(std::string_view name);
+      void bool_field(std::string_view name, bool value);
+
+      // Raw bytes as lower case hex
+      void hex_field(std::string_view name, std::string_view bytes);
+      // Raw UUID bytes in the canonical 8-4-4-4-12 form
+      void uuid_field(std::string_view name, std::string_view bytes);
+
+      template <class T>
+      void field(std::string_view name, const std::optional<T>& value){
+        if (value)
+          field(name, *value);
+        else
+          null_field(name);
+      }
+
+      // Write all buffered records
+      void flush();
+  };
+}
+
+#endif /* SRDP_OUTPUT_H */
@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+
+#include "output.h"
+
+const std::filesystem::path output_path("test_output.txt");
+
+static std::string write_records(srdp::OutputWriter::format_t format, size_t block_size){
+  std::filesystem::remove(output_path);
+  int fd = open(output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  REQUIRE( fd >= 0 );
+
+  {
+    srdp::OutputWriter out(format, fd, block_size);
+    for (int i=0; i < 3; i++) {
+      out.begin_record();
+      out.field("name", "a\"b\\c\td\ne" + std::to_string(i));
+      out.field("size", int64_t(i - 1));
+      out.field("owner", std::optional<std::string>());
+      out.hex_field("hash", std::string_view("\x01\xab", 2));
+      out.uuid_field("uuid", std::string_view("0123456789abcdef", 16));
+      out.end_record();
+    }
+  }
+  close(fd);
+
+  std::ifstream in(output_path);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  std::filesystem::remove(output_path);
+
+  return ss.str();
+}
+
+TEST_CASE("Output writer", "[output]") {
+  const std::string uuid = "30313233-3435-3637-3839-616263646566";
+
+  SECTION("JSON Lines") {
+    // Small blocks force several writes
+    for (size_t block : {1, 64, 1 << 16}) {
+      auto text = write_records(srdp::OutputWriter::format_t::jsonl, block);
+      REQUIRE( text ==
+          "{\"name\":\"a\\\"b\\\\c\\td\\ne0\",\"size\":-1,\"owner\":null,\"hash\":\"01ab\",\"uuid\":\"" + uuid + "\"}\n"
+          "{\"name\":\"a\\\"b\\\\c\\td\\ne1\",\"size\":0,\"owner\":null,\"hash\":\"01ab\",\"uuid\":\"" + uuid + "\"}\n"
+          "{\"name\":\"a\\\"b\\\\c\\td\\ne2\",\"size\":1,\"owner\":null,\"hash\":\"01ab\",\"uuid\":\"" + uuid + "\"}\n" );
+    }
+  }
+
+  SECTION("TSV") {
+    auto text = write_records(srdp::OutputWriter::format_t::tsv, 1);
+    REQUIRE( text ==
+        "name\tsize\towner\thash\tuuid\n"
+        "a\"b\\\\c\\td\\ne0\t-1\t\t01ab\t" + uuid + "\n"
+        "a\"b\\\\c\\td\\ne1\t0\t\t01ab\t" + uuid + "\n"
+        "a\"b\\\\c\\td\\ne2\t1\t\t01ab\t" + uuid + "\n" );
+  }
+
+  SECTION("Control characters") {
+    std::filesystem::remove(output_path);
+    int fd = open(output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    {
+      srdp::OutputWriter out(srdp::OutputWriter::format_t::jsonl, fd);
+      out.begin_record();
+      out.field("x", std::string_view("\x01\x1f", 2));
+      out.end_record();
+    }
+    close(fd);
+
+    std::ifstream in(output_path);
+    std::string line;
+    std::getline(in, line);
+    REQUIRE( line == "{\"x\":\"\\u0001\\u001f\"}" );
+    std::filesystem::remove(output_path);
+  }
+
+  SECTION("Formats") {
+    REQUIRE( srdp::OutputWriter::string_to_format("tsv") == srdp::OutputWriter::format_t::tsv );
+    REQUIRE_THROWS_AS( srdp::OutputWriter::string_to_format("xml"), std::invalid_argument );
+  }
+}
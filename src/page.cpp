@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "page.h"
+
+namespace srdp {
+
+  static std::string blob_to_hex(const Sql::blob_t& blob){
+    static const char digits[] = "0123456789abcdef";
+
+    std::string hex;
+    hex.reserve(blob.size() * 2);
+    for (unsigned char c : blob) {
+      hex += digits[c >> 4];
+      hex += digits[c & 15];
+    }
+
+    return hex;
+  }
+
+  static Sql::blob_t hex_to_blob(const std::string& hex){
+    auto nibble = [&hex](char c) -> unsigned char {
+      if (c >= '0' && c <= '9') return c - '0';
+      if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+      if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+      throw std::invalid_argument("Invalid cursor: " + hex);
+    };
+
+    if (hex.size() % 2 != 0)
+      throw std::invalid_argument("Invalid cursor: " + hex);
+
+    Sql::blob_t blob(hex.size() / 2);
+    for (size_t i=0; i < blob.size(); i++)
+      blob[i] = (nibble(hex[2 * i]) << 4) | nibble(hex[2 * i + 1]);
+
+    return blob;
+  }
+
+  PageOptions::sort_t PageOptions::string_to_sort(const std::string& sort){
+    if (sort == "ctime") return sort_t::ctime;
+    else if (sort == "name") return sort_t::name;
+    else if (sort == "path") return sort_t::path;
+    else if (sort == "hash") return sort_t::hash;
+    else if (sort == "role") return sort_t::role;
+    else
+      throw std::invalid_argument("Invalid sort key: " + sort);
+  }
+
+  std::string PageOptions::sort_to_string(sort_t sort){
+    switch (sort) {
+      case sort_t::none:
+        return "";
+      case sort_t::ctime:
+        return "ctime";
+      case sort_t::name:
+        return "name";
+      case sort_t::path:
+        return "path";
+      case sort_t::hash:
+        return "hash";
+      case sort_t::role:
+        return "role";
+    }
+
+    return "";
+  }
+
+  std::string PageOptions::make_cursor(const std::string& value, const Sql::blob_t& tie){
+    // The tie breaker is hex, so the last ':' separates it
+    return value + ":" + blob_to_hex(tie);
+  }
+
+  std::string PageOptions::make_cursor(const Sql::blob_t& value, const Sql::blob_t& tie){
+    return make_cursor(blob_to_hex(value), tie);
+  }
+
+  void PageOptions::apply(std::string& sql, Sql::vec_sql_t& bindings,
+      const std::string& key, key_t key_type, const std::string& tie, bool has_where,
+      const std::string& tie_value) const {
+
+    if (!after.empty()) {
+      const size_t sep = after.rfind(':');
+      if (sep == std::string::npos)
+        throw std::invalid_argument("Invalid cursor: " + after);
+
+      const std::string value = after.substr(0, sep);
+
+      sql += has_where ? " AND " : " WHERE ";
+      sql += "(" + key + ", " + tie + ") > (?, " + tie_value + ")";
+
+      switch (key_type) {
+        case key_t::integer:
+          try {
+            bindings.push_back(int64_t(std::stoll(value)));
+          } catch (std::logic_error&) {
+            throw std::invalid_argument("Invalid cursor: " + after);
+          }
+          break;
+        case key_t::text:
+          bindings.push_back(value);
+          break;
+        case key_t::blob:
+          bindings.push_back(hex_to_blob(value));
+          break;
+      }
+
+      bindings.push_back(hex_to_blob(after.substr(sep + 1)));
+    }
+
+    sql += " ORDER BY " + key + ", " + tie;
+
+    if (limit > 0) {
+      sql += " LIMIT ?";
+      bindings.push_back(int64_t(limit));
+    }
+  }
+}
@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_PAGE_H
+#define SRDP_PAGE_H
+
+#include "sql.h"
+
+namespace srdp {
+
+  /**
+   * Selects one page of a list (keyset pagination).
+   *
+   * Rows are ordered by a sort key and a unique tie breaker.
+   * The cursor of the last row of a page selects the rows after it,
+   * so reading a page costs one index seek plus limit rows, no matter
+   * how far into the list it is.
+   */
+  struct PageOptions {
+    enum class sort_t {
+      none,  // default order of the list
+      ctime,
+      name,
+      path,
+      hash,
+      role
+    };
+
+    enum class key_t {
+      integer,
+      text,
+      blob
+    };
+
+    sort_t sort = sort_t::none;
+    size_t limit = 0;   // 0 = all rows
+    std::string after;  // cursor of the last row of the previous page
+
+    static sort_t string_to_sort(const std::string& sort);
+    static std::string sort_to_string(sort_t sort);
+
+    // Cursor from the sort value and the tie breaker of a row
+    static std::string make_cursor(const std::string& value, const Sql::blob_t& tie);
+    static std::string make_cursor(const Sql::blob_t& value, const Sql::blob_t& tie);
+
+    /* Append the cursor condition, order, and limit to a query.
+     *
+     * key and tie are the SQL expressions of the sort key and tie breaker,
+     * has_where tells if the query already has a WHERE clause.
+     * tie_value is the SQL expression that turns the tie breaker of
+     * the cursor (bound as blob) into a value of tie.
+     */
+    void apply(std::string& sql, Sql::vec_sql_t& bindings,
+        const std::string& key, key_t key_type, const std::string& tie, bool has_where,
+        const std::string& tie_value = "?") const;
+  };
+}
+
+#endif /* SRDP_PAGE_H */
@@ -0,0 +1,183 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "files.h"
+
+const std::filesystem::path page_db_path("test_page.db");
+
+// Read all pages and return the names in order
+template<class T, class F>
+static std::vector<std::string> read_pages(T& obj, srdp::PageOptions page, F key){
+
+  std::vector<std::string> names;
+  for (;;) {
+    auto items = obj.list(page);
+    REQUIRE( items.size() <= page.limit );
+
+    for (auto& i : items) names.push_back(key(i));
+    if (items.size() < page.limit) break;
+
+    page.after = items.back().cursor(page.sort);
+  }
+
+  return names;
+}
+
+TEST_CASE("Paged lists", "[page]") {
+  std::filesystem::remove(page_db_path);
+  std::shared_ptr<srdp::Sql> db = std::make_shared<srdp::Sql>(page_db_path);
+
+  REQUIRE_NOTHROW( srdp::Project::create_table(*db) );
+  REQUIRE_NOTHROW( srdp::Experiment::create_table(*db) );
+  REQUIRE_NOTHROW( srdp::File::create_table(*db) );
+
+  // Equal ctimes keep the creation order, names sort differently than ctimes
+  const std::vector<std::string> names{"e", "d:x", "c", "b", "a", "f", "g"};
+  for (size_t i=0; i < names.size(); i++) {
+    srdp::Project p(db, names[i], true);
+    p.ctime = i / 2;
+    p.update();
+  }
+
+  srdp::Project prj(db, "c", false);
+  for (size_t i=0; i < names.size(); i++) {
+    srdp::Experiment e(db, prj, names[i], true);
+    if (i != 3) e.ctime = i + 1;
+    e.update();
+  }
+
+  srdp::Experiment exp(db, prj, "a", false);
+  for (unsigned char i=0; i < 9; i++) {
+    srdp::File f(db, exp);
+    f.hash.fill(9 - i);
+    f.size = 10 + i;
+    if (i != 4) f.path = "file" + std::to_string(i);
+    f.role = srdp::File::role_t(i % 3 + 1);
+    f.create();
+  }
+
+  SECTION("Projects") {
+    srdp::Project p(db);
+    auto name = [](const srdp::Project& p) { return p.name; };
+
+    std::vector<std::string> all;
+    for (auto& i : p.list()) all.push_back(i.name);
+    REQUIRE( all.size() == names.size() );
+
+    srdp::PageOptions page;
+    for (size_t limit : {1, 2, 3, 7, 8}) {
+      page.limit = limit;
+      REQUIRE( read_pages(p, page, name) == all );
+    }
+
+    page.sort = srdp::PageOptions::sort_t::name;
+    page.limit = 2;
+    REQUIRE( read_pages(p, page, name) == std::vector<std::string>{"a", "b", "c", "d:x", "e", "f", "g"} );
+
+    page.sort = srdp::PageOptions::sort_t::path;
+    REQUIRE_THROWS( p.list(page) );
+  }
+
+  SECTION("Experiments") {
+    srdp::Experiment e(db, prj);
+    auto name = [](const srdp::Experiment& e) { return e.name; };
+
+    // Missing ctime sorts first
+    srdp::PageOptions page;
+    page.limit = 3;
+    REQUIRE( read_pages(e, page, name) == std::vector<std::string>{"b", "e", "d:x", "c", "a", "f", "g"} );
+
+    page.sort = srdp::PageOptions::sort_t::name;
+    REQUIRE( read_pages(e, page, name) == std::vector<std::string>{"a", "b", "c", "d:x", "e", "f", "g"} );
+
+    // Experiments of other projects are not listed
+    srdp::Experiment other(db, srdp::Project(db, "a", false));
+    REQUIRE( other.list(page).empty() );
+  }
+
+  SECTION("Files") {
+    srdp::File f(db, exp);
+    const size_t exp_hash_size = f.hash.size();
+    auto size = [](const srdp::File& f) { return std::to_string(f.size - 10); };
+
+    std::vector<std::string> all;
+    for (auto& i : f.list()) {
+      all.push_back(size(i));
+      // Complete file properties are loaded
+      REQUIRE( i.role );
+      REQUIRE( i.experiment == exp.uuid );
+    }
+    REQUIRE( all.size() == 9 );
+
+    // Streamed rows match the listed files
+    std::vector<std::string> scanned;
+    f.scan(srdp::PageOptions(), std::optional<srdp::File::role_t>(), [&](const srdp::File::view_t& row) {
+      REQUIRE( row.hash.size() == exp_hash_size );
+      REQUIRE( (row.path || row.size == 14) );
+      scanned.push_back(std::to_string(row.size - 10));
+    });
+    REQUIRE( scanned == all );
+
+    srdp::PageOptions page;
+    page.limit = 2;
+    REQUIRE( read_pages(f, page, size) == all );
+
+    page.sort = srdp::PageOptions::sort_t::path;
+    REQUIRE( read_pages(f, page, size) == std::vector<std::string>{"4", "0", "1", "2", "3", "5", "6", "7", "8"} );
+
+    page.sort = srdp::PageOptions::sort_t::hash;
+    REQUIRE( read_pages(f, page, size) == std::vector<std::string>{"8", "7", "6", "5", "4", "3", "2", "1", "0"} );
+
+    // Role filter and paging combine
+    page.sort = srdp::PageOptions::sort_t::none;
+    page.limit = 1;
+    auto outputs = f.list(page, srdp::File::role_t::output);
+    REQUIRE( outputs.size() == 1 );
+    page.after = outputs.back().cursor(page.sort);
+    page.limit = 10;
+    REQUIRE( f.list(page, srdp::File::role_t::output).size() == 2 );
+
+    page.sort = srdp::PageOptions::sort_t::name;
+    REQUIRE_THROWS( f.list(page) );
+  }
+
+  SECTION("Invalid cursors") {
+    srdp::Project p(db);
+    srdp::PageOptions page;
+
+    page.after = "nocolon";
+    REQUIRE_THROWS_AS( p.list(page), std::invalid_argument );
+    page.after = "abc:00";
+    REQUIRE_THROWS_AS( p.list(page), std::invalid_argument );
+    page.after = "1:0g";
+    REQUIRE_THROWS_AS( p.list(page), std::invalid_argument );
+
+    REQUIRE_THROWS_AS( srdp::PageOptions::string_to_sort("size"), std::invalid_argument );
+    REQUIRE( srdp::PageOptions::string_to_sort("path") == srdp::PageOptions::sort_t::path );
+  }
+
+  SECTION("Pages are read from the index") {
+    // The sort must not need a temporary b-tree
+    auto res = db->query(R"(
+        EXPLAIN QUERY PLAN
+        SELECT uuid FROM experiments WHERE project = ? AND (IFNULL(ctime, 0), rowid) > (?, ?)
+        ORDER BY IFNULL(ctime, 0), rowid LIMIT 10
+      )",
+      srdp::Sql::vec_sql_t{srdp::bin_to_blob(prj.uuid), int64_t(0), int64_t(0)},
+      srdp::Sql::vec_sql_t{int64_t(0), int64_t(0), int64_t(0), std::string()});
+
+    std::string plan;
+    while (res) {
+      plan += std::get<std::string>(*(*res)[3]) + "\n";
+      res = db->next_row();
+    }
+
+    REQUIRE( plan.find("idx_experiment_ctime") != std::string::npos );
+    REQUIRE( plan.find("TEMP B-TREE") == std::string::npos );
+  }
+
+  std::filesystem::remove(page_db_path);
+}
@@ -0,0 +1,159 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <catch2/catch_test_macros.hpp>
+
+#include "srdp.h"
+#include "sys_calls.h"
+
+/*
+ * Budgets for SQL statements and file system calls.
+ *
+ * A count must not exceed fixed + per_item * N of the baseline file,
+ * where N is the number of files handled. Each operation is run for
+ * two sizes of N, so O(1) and O(N) budgets are both enforced.
+ * The tests are hidden from the default run, ctest runs them as perf_test.
+ */
+
+#ifndef SRDP_PERF_BASELINE
+#define SRDP_PERF_BASELINE "perf_baseline.txt"
+#endif
+
+namespace {
+
+  struct budget_t {
+    double fixed;
+    double per_item;
+  };
+
+  std::map<std::string, budget_t> load_baseline(){
+    std::ifstream file(SRDP_PERF_BASELINE);
+    if (!file.is_open())
+      throw std::runtime_error("Can not open " + std::string(SRDP_PERF_BASELINE));
+
+    std::map<std::string, budget_t> baseline;
+    std::string line;
+    while (std::getline(file, line)) {
+      if (line.empty() || line[0] == '#') continue;
+
+      std::istringstream fields(line);
+      std::string name;
+      budget_t budget;
+      if (!(fields >> name >> budget.fixed >> budget.per_item))
+        throw std::runtime_error("Invalid baseline entry: " + line);
+
+      baseline[name] = budget;
+    }
+
+    return baseline;
+  }
+
+  // Count the statements of all connections while in scope
+  class StatementCounter {
+    private:
+      std::atomic<uint64_t> statements{0};
+
+    public:
+      StatementCounter(){
+        srdp::Sql::set_hook([this](const std::string&) { statements++; });
+      }
+
+      ~StatementCounter(){
+        srdp::Sql::set_hook(nullptr);
+      }
+
+      uint64_t get() const { return statements; }
+  };
+
+  struct counts_t {
+    uint64_t statements;
+    uint64_t fs_calls;
+  };
+
+  counts_t count(const std::function<void()>& f){
+    StatementCounter counter;
+    const auto before = srdp::sys::get_counts();
+
+    f();
+
+    return counts_t{counter.get(), (srdp::sys::get_counts() - before).total()};
+  }
+
+  void check(const std::map<std::string, budget_t>& baseline, const std::string& name, size_t n, uint64_t value){
+    INFO( name << " with N = " << n << ": " << value );
+    REQUIRE( baseline.count(name) == 1 );
+
+    const budget_t& budget = baseline.at(name);
+    CHECK( double(value) <= budget.fixed + budget.per_item * double(n) );
+  }
+}
+
+TEST_CASE("Performance budgets", "[.perf]") {
+  const fs::path base_dir = fs::absolute("test_perf");
+  auto old_cwd = fs::current_path();
+
+  const auto baseline = load_baseline();
+
+  for (size_t n : {20, 200}) {
+    fs::remove_all(base_dir);
+    fs::create_directory(base_dir);
+    fs::current_path(base_dir);
+
+    REQUIRE_NOTHROW( srdp::Srdp::init("./") );
+
+    {
+      srdp::Srdp dp;
+      dp.create_project("project");
+      const srdp::Experiment exp = dp.create_experiment("exp");
+
+      // Half of the files are added, spread over a few directories
+      std::vector<fs::path> names;
+      for (size_t i=0; i < n; i++) {
+        const fs::path dir = "d" + std::to_string(i % 4);
+        fs::create_directories(dir);
+
+        const fs::path name = dir / ("f" + std::to_string(i));
+        std::ofstream(name) << "content " << i;
+
+        if (i % 2 == 0) names.push_back(name);
+      }
+
+      auto counts = count([&]() { dp.add_files(exp, names, srdp::File::role_t::output); });
+      check(baseline, "add_files.statements", names.size(), counts.statements);
+
+      srdp::File file = dp.get_file("", "exp");
+      counts = count([&]() { REQUIRE( file.list().size() == names.size() ); });
+      check(baseline, "file_list.statements", names.size(), counts.statements);
+
+      counts = count([&]() { REQUIRE( dp.get_file_list(true, 1, false).size() == n ); });
+      check(baseline, "status.statements", n, counts.statements);
+      check(baseline, "status.fs_calls", n, counts.fs_calls);
+
+      // Unchanged directories are taken from the index.
+      // Recently modified directories are not reused, so they are backdated.
+      const auto old_time = fs::file_time_type::clock::now() - std::chrono::hours(1);
+      fs::last_write_time(".", old_time);
+      for (size_t i=0; i < 4; i++)
+        fs::last_write_time("d" + std::to_string(i), old_time);
+
+      dp.get_file_list(true, 1, true);
+      counts = count([&]() { REQUIRE( dp.get_file_list(true, 1, true).size() == n ); });
+      check(baseline, "status_index.statements", n, counts.statements);
+      check(baseline, "status_index.fs_calls", n, counts.fs_calls);
+
+      counts = count([&]() { dp.verify(); });
+      check(baseline, "verify.statements", names.size(), counts.statements);
+      check(baseline, "verify.fs_calls", names.size(), counts.fs_calls);
+    }
+
+    fs::current_path(old_cwd);
+  }
+
+  REQUIRE_NOTHROW( fs::remove_all(base_dir) );
+}
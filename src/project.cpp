@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "project.h"
+#include "journal.h"
 #include <boost/uuid/uuid_io.hpp>
 #include <iostream>
 namespace srdp {
@@ -60,11 +61,13 @@ namespace srdp {
           name VARCHAR(128) NOT NULL,
           metadata TEXT,
           owner TEXT,
-          ctime INTEGER,
-          journal TEXT
+          ctime INTEGER
         );
         CREATE INDEX IF NOT EXISTS idx_project_name ON projects (name);
+        CREATE INDEX IF NOT EXISTS idx_project_ctime ON projects (IFNULL(ctime, 0));
       )");
+
+      Journal::create_table(db);
   }
 
   void Project::create(const std::string& new_name){
@@ -140,6 +143,7 @@ namespace srdp {
   void Project::remove(){
     db->query("DELETE FROM projects WHERE uuid = ?",
              Sql::vec_sql_t{bin_to_blob(uuid)});
+    journal().clear();
 
     uuid = uuids::random_generator()();
     name = std::string();
@@ -149,8 +153,30 @@ namespace srdp {
   }
 
   std::vector<Project> Project::list(){
-    auto res = db->query("SELECT uuid, name, metadata, owner, ctime FROM projects ORDER BY ctime",
-             Sql::vec_sql_t{},
+    return list(PageOptions());
+  }
+
+  std::vector<Project> Project::list(const PageOptions& page){
+    std::string sql = "SELECT uuid, name, metadata, owner, ctime FROM projects";
+    Sql::vec_sql_t bindings;
+
+    // Ties keep the creation order, the cursor holds the uuid of its row.
+    // A removed cursor row repeats its ties instead of skipping them.
+    const std::string tie_value = "IFNULL((SELECT rowid FROM projects WHERE uuid = ?), 0)";
+
+    switch (page.sort) {
+      case PageOptions::sort_t::none:
+      case PageOptions::sort_t::ctime:
+        page.apply(sql, bindings, "IFNULL(ctime, 0)", PageOptions::key_t::integer, "rowid", false, tie_value);
+        break;
+      case PageOptions::sort_t::name:
+        page.apply(sql, bindings, "name", PageOptions::key_t::text, "rowid", false, tie_value);
+        break;
+      default:
+        throw std::invalid_argument("Projects can not be sorted by " + PageOptions::sort_to_string(page.sort));
+    }
+
+    auto res = db->query(sql, bindings,
              Sql::vec_sql_t{Sql::blob_t(), // uuid
                             std::string(), // name
                             std::string(), // meta
@@ -176,29 +202,28 @@ namespace srdp {
     return project_list;
   }
 
+  std::string Project::cursor(PageOptions::sort_t sort) const {
+    if (sort == PageOptions::sort_t::name)
+      return PageOptions::make_cursor(name, bin_to_blob(uuid));
+    else
+      return PageOptions::make_cursor(std::to_string(ctime.value_or(0)), bin_to_blob(uuid));
+  }
 
-  std::string Project::get_journal(){
-    auto res = db->query("SELECT journal FROM projects WHERE uuid = ?;",
-             Sql::vec_sql_t{bin_to_blob(uuid)},
-             Sql::vec_sql_t{std::string()});
-
-    if (!res)
-      throw std::runtime_error("Invalid project UUID");
 
-    auto row = *res;
+  Journal Project::journal(){
+    return Journal(db, uuid);
+  }
 
-    if (row[0]) return std::get<std::string>(*row[0]);
-    else return "";
+  std::string Project::get_journal(){
+    return journal().get();
   }
 
   void Project::set_journal(const std::string& text){
-    db->query("UPDATE projects SET journal = ? WHERE uuid = ?;",
-             Sql::vec_sql_t{text, bin_to_blob(uuid)});
+    journal().set(text);
   }
 
   void Project::append_journal(const std::string& text){
-    db->query("UPDATE projects SET journal = concat(journal, ?) WHERE uuid = ?;",
-             Sql::vec_sql_t{text, bin_to_blob(uuid)});
+    journal().append(text);
   }
 
   ///
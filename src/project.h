@@ -11,6 +11,7 @@
 #include <filesystem>
 
 #include "sql.h"
+#include "page.h"
 
 namespace srdp {
 
@@ -21,12 +22,14 @@ namespace srdp {
   ctime_t get_timestamp_now();
 
 
+  class Journal;
+
   class Project {
     private:
       std::shared_ptr<Sql> db;
 
     public:
-      uuids::uuid uuid;
+      uuids::uuid uuid = uuids::nil_uuid();
       std::string name;
       std::optional<std::string> metadata;
       std::optional<std::string> owner;
@@ -44,7 +47,13 @@ namespace srdp {
 
       void update();
       std::vector<Project> list();
+      // Sorted by ctime (default) or name
+      std::vector<Project> list(const PageOptions& page);
+      // Cursor selecting the projects after this one
+      std::string cursor(PageOptions::sort_t sort) const;
 
+      // Journal entries, appends do not rewrite the journal
+      Journal journal();
       std::string get_journal();
       void set_journal(const std::string& text);
       void append_journal(const std::string& text);
@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "report.h"
+
+namespace srdp {
+
+  Report::Report(std::shared_ptr<Sql>& dbin) : db(dbin)
+  {
+    if (!db)
+      throw std::runtime_error("Invalid DB pointer.");
+  }
+
+  void Report::assets(const Project& prj, const assets_visitor_t& visitor){
+    auto res = db->query(R"(
+        SELECT
+          e.uuid, e.name, e.metadata, e.owner, e.ctime, e.locked,
+          m.hash, m.path, m.role,
+          f.size, f.name, f.creator, f.owner, f.ctime, f.metadata,
+          cp.name, c.name
+        FROM experiments e
+        LEFT JOIN file_map m ON m.uuid = e.uuid
+        LEFT JOIN files f ON f.hash = m.hash
+        LEFT JOIN experiments c ON c.uuid = f.creator
+        LEFT JOIN projects cp ON cp.uuid = c.project
+        WHERE e.project = ?
+        ORDER BY e.ctime, e.uuid, m.role, m.path;
+      )",
+       Sql::vec_sql_t{bin_to_blob(prj.uuid)},
+       Sql::vec_sql_t{Sql::blob_t(),  // experiment uuid
+                      std::string(),  // name
+                      std::string(),  // metadata
+                      std::string(),  // owner
+                      int64_t(0),     // ctime
+                      bool(false),    // locked
+                      Sql::blob_t(),  // hash
+                      std::string(),  // path
+                      int(0),         // role
+                      int64_t(0),     // size
+                      std::string(),  // name
+                      Sql::blob_t(),  // creator
+                      std::string(),  // owner
+                      int64_t(0),     // ctime
+                      std::string(),  // metadata
+                      std::string(),  // creator project
+                      std::string()}); // creator experiment
+
+    Experiment exp(db, prj);
+    exp.uuid = uuids::nil_uuid();
+
+    while (res) {
+      auto row = *res;
+
+      // Rows are grouped by experiment
+      const auto exp_uuid = blob_to_bin<uuids::uuid>(std::get<Sql::blob_t>(*row[0]));
+      if (exp_uuid != exp.uuid) {
+        exp.uuid = exp_uuid;
+        exp.name = std::get<std::string>(*row[1]);
+        exp.metadata = Sql::sql_repack_optional<std::string>(row[2]);
+        exp.owner = Sql::sql_repack_optional<std::string>(row[3]);
+        exp.ctime = Sql::sql_repack_optional<ctime_t>(row[4]);
+        exp.locked = row[5] ? std::get<bool>(*row[5]) : false;
+
+        if (visitor.experiment) visitor.experiment(exp);
+      }
+
+      // Experiments without files have a single row without file
+      if (row[6] && visitor.file) {
+        File f(db, exp.uuid);
+        f.hash = blob_to_bin<scas::Hash::hash_t>(std::get<Sql::blob_t>(*row[6]));
+        f.path = Sql::sql_repack_optional<std::string>(row[7]);
+        f.role = Sql::sql_repack_optional<int, File::role_t>(row[8], [](int in){return File::role_t(in);});
+        f.size = row[9] ? std::get<int64_t>(*row[9]) : 0;
+        f.original_name = Sql::sql_repack_optional<std::string>(row[10]);
+        f.creator_uuid = Sql::sql_repack_optional<Sql::blob_t, uuids::uuid>(row[11], blob_to_bin<uuids::uuid>);
+        f.owner = Sql::sql_repack_optional<std::string>(row[12]);
+        f.ctime = Sql::sql_repack_optional<int64_t>(row[13]);
+        f.metadata = Sql::sql_repack_optional<std::string>(row[14]);
+
+        std::string creator;
+        if (row[15] && row[16])
+          creator = std::get<std::string>(*row[15]) + "::" + std::get<std::string>(*row[16]);
+
+        visitor.file(f, creator);
+      }
+
+      res = db->next_row();
+    }
+  }
+}
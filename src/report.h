@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_REPORT_H
+#define SRDP_REPORT_H
+
+#include <functional>
+
+#include "files.h"
+
+namespace srdp {
+
+  /**
+   * Reports over the project hierarchy.
+   *
+   * Each report is a single ordered query whose rows are handed
+   * to callbacks while stepping. The callbacks must not use the
+   * same DB connection.
+   */
+  class Report {
+    private:
+      std::shared_ptr<Sql> db;
+
+    public:
+      struct assets_visitor_t {
+        std::function<void(const Experiment& exp)> experiment;
+        // creator is "project::experiment" of the creating experiment, empty if unknown
+        std::function<void(const File& file, const std::string& creator)> file;
+      };
+
+      Report(std::shared_ptr<Sql>& dbin);
+
+      /**
+       * All experiments of a project in creation order,
+       * each followed by its files ordered by role and path.
+       */
+      void assets(const Project& prj, const assets_visitor_t& visitor);
+  };
+}
+
+#endif /* SRDP_REPORT_H */
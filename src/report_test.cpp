@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "report.h"
+
+const std::filesystem::path report_db_path("test_report.db");
+
+TEST_CASE("Assets report", "[report]") {
+  std::filesystem::remove(report_db_path);
+  std::shared_ptr<srdp::Sql> db = std::make_shared<srdp::Sql>(report_db_path);
+
+  REQUIRE_NOTHROW( srdp::Project::create_table(*db) );
+  REQUIRE_NOTHROW( srdp::Experiment::create_table(*db) );
+  REQUIRE_NOTHROW( srdp::File::create_table(*db) );
+
+  srdp::Project prj(db, "project", true);
+  srdp::Project other(db, "other", true);
+
+  // Experiments with distinct creation times
+  std::vector<srdp::Experiment> exps;
+  for (int i=0; i < 3; i++) {
+    exps.emplace_back(db, prj, "exp" + std::to_string(i), true);
+    exps.back().ctime = i;
+    exps.back().update();
+  }
+  srdp::Experiment other_exp(db, other, "other", true);
+
+  auto add_file = [&db](const srdp::Experiment& exp, unsigned char id, srdp::File::role_t role) {
+    srdp::File f(db, exp);
+    f.hash.fill(id);
+    f.size = id;
+    f.path = "file" + std::to_string(id);
+    f.role = role;
+    f.create();
+  };
+
+  add_file(exps[0], 1, srdp::File::role_t::output);
+  add_file(exps[0], 2, srdp::File::role_t::input);
+  add_file(exps[2], 1, srdp::File::role_t::input);
+  add_file(other_exp, 3, srdp::File::role_t::input);
+
+  std::vector<std::string> lines;
+  srdp::Report::assets_visitor_t visitor;
+  visitor.experiment = [&lines](const srdp::Experiment& e) {
+    lines.push_back(e.name);
+  };
+  visitor.file = [&lines](const srdp::File& f, const std::string& creator) {
+    lines.push_back("  " + *f.path + " " + srdp::File::role_to_string(*f.role) + " " + creator);
+  };
+
+  REQUIRE_NOTHROW( srdp::Report(db).assets(prj, visitor) );
+
+  // Each experiment lists its own files, experiments without files are kept
+  REQUIRE( lines == std::vector<std::string>{
+      "exp0",
+      "  file2 input ",
+      "  file1 output project::exp0",
+      "exp1",
+      "exp2",
+      "  file1 input project::exp0"} );
+
+  // Callbacks are optional
+  srdp::Report::assets_visitor_t empty;
+  REQUIRE_NOTHROW( srdp::Report(db).assets(other, empty) );
+
+  std::filesystem::remove(report_db_path);
+}
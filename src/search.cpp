@@ -0,0 +1,271 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <sstream>
+
+#include "search.h"
+
+namespace srdp {
+
+  std::string Search::kind_to_string(kind_t kind){
+    switch (kind) {
+      case kind_t::project:
+        return "project";
+      case kind_t::experiment:
+        return "experiment";
+      case kind_t::journal:
+        return "journal";
+      case kind_t::file:
+        return "file";
+      case kind_t::path:
+        return "path";
+    }
+
+    return "";
+  }
+
+  void Search::create_table(Sql& db){
+    // search_docs maps the rows of the FTS table to their source:
+    // key is the uuid (project, experiment), the entry id (journal),
+    // or the hash (file, path).
+    db.exec(R"(
+        CREATE TABLE IF NOT EXISTS search_docs (
+          id INTEGER PRIMARY KEY,
+          kind INTEGER NOT NULL,
+          key BLOB NOT NULL,
+          project BLOB(16),
+          experiment BLOB(16)
+        );
+
+        CREATE INDEX IF NOT EXISTS idx_search_docs ON search_docs (kind, key, experiment);
+
+        CREATE VIRTUAL TABLE IF NOT EXISTS search_index USING fts5(name, text, prefix='2 3');
+
+        CREATE TRIGGER IF NOT EXISTS search_projects_insert AFTER INSERT ON projects BEGIN
+          INSERT INTO search_docs (kind, key, project) VALUES (1, new.uuid, new.uuid);
+          INSERT INTO search_index (rowid, name, text) VALUES (last_insert_rowid(), new.name, new.metadata);
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS search_projects_update AFTER UPDATE OF name, metadata ON projects BEGIN
+          UPDATE search_index SET name = new.name, text = new.metadata
+            WHERE rowid = (SELECT id FROM search_docs WHERE kind = 1 AND key = old.uuid);
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS search_projects_delete AFTER DELETE ON projects BEGIN
+          DELETE FROM search_index WHERE rowid IN (SELECT id FROM search_docs WHERE kind = 1 AND key = old.uuid);
+          DELETE FROM search_docs WHERE kind = 1 AND key = old.uuid;
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS search_experiments_insert AFTER INSERT ON experiments BEGIN
+          INSERT INTO search_docs (kind, key, project, experiment) VALUES (2, new.uuid, new.project, new.uuid);
+          INSERT INTO search_index (rowid, name, text) VALUES (last_insert_rowid(), new.name, new.metadata);
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS search_experiments_update AFTER UPDATE OF name, metadata ON experiments BEGIN
+          UPDATE search_index SET name = new.name, text = new.metadata
+            WHERE rowid = (SELECT id FROM search_docs WHERE kind = 2 AND key = old.uuid);
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS search_experiments_delete AFTER DELETE ON experiments BEGIN
+          DELETE FROM search_index WHERE rowid IN (SELECT id FROM search_docs WHERE kind = 2 AND key = old.uuid);
+          DELETE FROM search_docs WHERE kind = 2 AND key = old.uuid;
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS search_journal_insert AFTER INSERT ON journal_entries BEGIN
+          INSERT INTO search_docs (kind, key, project, experiment) VALUES (3, new.id,
+            COALESCE((SELECT project FROM experiments WHERE uuid = new.owner), new.owner),
+            (SELECT uuid FROM experiments WHERE uuid = new.owner));
+          INSERT INTO search_index (rowid, name, text) VALUES (last_insert_rowid(), NULL, new.text);
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS search_journal_delete AFTER DELETE ON journal_entries BEGIN
+          DELETE FROM search_index WHERE rowid IN (SELECT id FROM search_docs WHERE kind = 3 AND key = old.id);
+          DELETE FROM search_docs WHERE kind = 3 AND key = old.id;
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS search_files_insert AFTER INSERT ON files BEGIN
+          INSERT INTO search_docs (kind, key) VALUES (4, new.hash);
+          INSERT INTO search_index (rowid, name, text) VALUES (last_insert_rowid(), new.name, new.metadata);
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS search_files_update AFTER UPDATE OF name, metadata ON files BEGIN
+          UPDATE search_index SET name = new.name, text = new.metadata
+            WHERE rowid = (SELECT id FROM search_docs WHERE kind = 4 AND key = old.hash);
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS search_files_delete AFTER DELETE ON files BEGIN
+          DELETE FROM search_index WHERE rowid IN (SELECT id FROM search_docs WHERE kind = 4 AND key = old.hash);
+          DELETE FROM search_docs WHERE kind = 4 AND key = old.hash;
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS search_file_map_insert AFTER INSERT ON file_map BEGIN
+          INSERT INTO search_docs (kind, key, project, experiment) VALUES (5, new.hash,
+            (SELECT project FROM experiments WHERE uuid = new.uuid), new.uuid);
+          INSERT INTO search_index (rowid, name, text) VALUES (last_insert_rowid(), new.path, NULL);
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS search_file_map_update AFTER UPDATE OF path ON file_map BEGIN
+          UPDATE search_index SET name = new.path
+            WHERE rowid = (SELECT id FROM search_docs WHERE kind = 5 AND key = old.hash AND experiment = old.uuid);
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS search_file_map_delete AFTER DELETE ON file_map BEGIN
+          DELETE FROM search_index WHERE rowid IN
+            (SELECT id FROM search_docs WHERE kind = 5 AND key = old.hash AND experiment = old.uuid);
+          DELETE FROM search_docs WHERE kind = 5 AND key = old.hash AND experiment = old.uuid;
+        END;
+    )");
+  }
+
+  void Search::rebuild(Sql& db){
+    db.exec(R"(
+        DELETE FROM search_index;
+        DELETE FROM search_docs;
+
+        INSERT INTO search_docs (kind, key, project)
+          SELECT 1, uuid, uuid FROM projects;
+        INSERT INTO search_docs (kind, key, project, experiment)
+          SELECT 2, uuid, project, uuid FROM experiments;
+        INSERT INTO search_docs (kind, key, project, experiment)
+          SELECT 3, j.id, COALESCE(e.project, j.owner), e.uuid
+          FROM journal_entries j LEFT JOIN experiments e ON e.uuid = j.owner;
+        INSERT INTO search_docs (kind, key)
+          SELECT 4, hash FROM files;
+        INSERT INTO search_docs (kind, key, project, experiment)
+          SELECT 5, m.hash, e.project, m.uuid
+          FROM file_map m LEFT JOIN experiments e ON e.uuid = m.uuid;
+
+        INSERT INTO search_index (rowid, name, text)
+          SELECT d.id, p.name, p.metadata FROM search_docs d
+          JOIN projects p ON p.uuid = d.key WHERE d.kind = 1;
+        INSERT INTO search_index (rowid, name, text)
+          SELECT d.id, e.name, e.metadata FROM search_docs d
+          JOIN experiments e ON e.uuid = d.key WHERE d.kind = 2;
+        INSERT INTO search_index (rowid, name, text)
+          SELECT d.id, NULL, j.text FROM search_docs d
+          JOIN journal_entries j ON j.id = d.key WHERE d.kind = 3;
+        INSERT INTO search_index (rowid, name, text)
+          SELECT d.id, f.name, f.metadata FROM search_docs d
+          JOIN files f ON f.hash = d.key WHERE d.kind = 4;
+        INSERT INTO search_index (rowid, name, text)
+          SELECT d.id, m.path, NULL FROM search_docs d
+          JOIN file_map m ON m.hash = d.key AND m.uuid = d.experiment WHERE d.kind = 5;
+    )");
+  }
+
+  std::string Search::quote(const std::string& text){
+    std::istringstream words(text);
+    std::string word;
+    std::string query;
+
+    while (words >> word) {
+      const bool prefix = word.size() > 1 && word.back() == '*';
+      if (prefix) word.pop_back();
+
+      if (!query.empty()) query += ' ';
+      query += '"';
+      for (char c : word) {
+        if (c == '"') query += '"';
+        query += c;
+      }
+      query += '"';
+      if (prefix) query += '*';
+    }
+
+    return query;
+  }
+
+  Search::Search(std::shared_ptr<Sql>& dbin) : db(dbin)
+  {
+    if (!db)
+      throw std::runtime_error("Invalid DB pointer.");
+  }
+
+  std::vector<Search::result_t> Search::query(const options_t& opts){
+    const std::string match = opts.raw ? opts.query : quote(opts.query);
+    if (match.empty())
+      throw std::invalid_argument("Empty search query");
+
+    std::string sql = R"(
+        SELECT d.kind, p.name, e.name, search_index.name,
+               CASE WHEN d.kind IN (4, 5) THEN d.key END,
+               snippet(search_index, -1, '[', ']', '...', 12)
+        FROM search_index
+        JOIN search_docs d ON d.id = search_index.rowid
+        LEFT JOIN projects p ON p.uuid = d.project
+        LEFT JOIN experiments e ON e.uuid = d.experiment
+        WHERE search_index MATCH ?
+      )";
+    Sql::vec_sql_t bindings{match};
+
+    // Files (kind 4) belong to experiments through their mappings
+    if (opts.project) {
+      sql += R"(
+        AND (d.project = ? OR (d.kind = 4 AND EXISTS (
+          SELECT 1 FROM file_map m JOIN experiments x ON x.uuid = m.uuid
+          WHERE m.hash = d.key AND x.project = ?)))
+      )";
+      bindings.push_back(bin_to_blob(*opts.project));
+      bindings.push_back(bin_to_blob(*opts.project));
+    }
+
+    if (opts.experiment) {
+      sql += R"(
+        AND (d.experiment = ? OR (d.kind = 4 AND EXISTS (
+          SELECT 1 FROM file_map m WHERE m.hash = d.key AND m.uuid = ?)))
+      )";
+      bindings.push_back(bin_to_blob(*opts.experiment));
+      bindings.push_back(bin_to_blob(*opts.experiment));
+    }
+
+    if (opts.role) {
+      sql += R"(
+        AND d.kind IN (4, 5) AND EXISTS (
+          SELECT 1 FROM file_map m WHERE m.hash = d.key AND m.role = ?
+          AND (d.experiment IS NULL OR m.uuid = d.experiment))
+      )";
+      bindings.push_back(int(*opts.role));
+    }
+
+    // Matches in names weigh more than in texts
+    sql += " ORDER BY bm25(search_index, 5.0, 1.0) LIMIT ?;";
+    bindings.push_back(int64_t(opts.limit));
+
+    const Sql::vec_sql_t types{int(0),        // kind
+                               std::string(), // project
+                               std::string(), // experiment
+                               std::string(), // name
+                               Sql::blob_t(), // hash
+                               std::string()}; // snippet
+
+    std::optional<Sql::vec_sql_opt_t> res;
+    try {
+      res = db->query(sql, bindings, types);
+    } catch (std::runtime_error& e) {
+      if (!opts.raw) throw;
+      throw std::invalid_argument("Invalid search query: " + match);
+    }
+
+    std::vector<result_t> results;
+
+    while (res) {
+      auto row = *res;
+
+      result_t r;
+      r.kind = kind_t(std::get<int>(*row[0]));
+      r.project = Sql::sql_repack_optional<std::string>(row[1]);
+      r.experiment = Sql::sql_repack_optional<std::string>(row[2]);
+      r.name = Sql::sql_repack_optional<std::string>(row[3]);
+      if (row[4])
+        r.hash = blob_to_bin<scas::Hash::hash_t>(std::get<Sql::blob_t>(*row[4]));
+      if (row[5])
+        r.snippet = std::get<std::string>(*row[5]);
+
+      results.push_back(std::move(r));
+      res = db->next_row();
+    }
+
+    return results;
+  }
+}
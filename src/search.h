@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_SEARCH_H
+#define SRDP_SEARCH_H
+
+#include "files.h"
+
+namespace srdp {
+
+  /**
+   * Full-text search (SQLite FTS5).
+   *
+   * Project and experiment names and abstracts, journal entries,
+   * file names and metadata, and mapped paths are indexed.
+   * Triggers on the source tables keep the index up to date,
+   * so every write path is covered without further calls.
+   */
+  class Search {
+    private:
+      std::shared_ptr<Sql> db;
+
+    public:
+      enum class kind_t {
+        project = 1,
+        experiment = 2,
+        journal = 3,
+        file = 4,
+        path = 5
+      };
+
+      struct options_t {
+        std::string query;
+        bool raw = false; // query is in FTS5 syntax
+        std::optional<uuids::uuid> project;
+        std::optional<uuids::uuid> experiment;
+        std::optional<File::role_t> role; // only files
+        size_t limit = 20;
+      };
+
+      struct result_t {
+        kind_t kind;
+        std::optional<std::string> project;    // name
+        std::optional<std::string> experiment; // name
+        std::optional<std::string> name;       // name or path of the match
+        std::optional<scas::Hash::hash_t> hash;
+        std::string snippet;
+      };
+
+      static std::string kind_to_string(kind_t kind);
+
+      // Needs all other tables to exist
+      static void create_table(Sql& db);
+
+      // Index all existing rows again
+      static void rebuild(Sql& db);
+
+      /**
+       * Turn free text into an FTS5 query.
+       * Every word is searched literally, a trailing '*' matches a prefix.
+       */
+      static std::string quote(const std::string& text);
+
+      Search(std::shared_ptr<Sql>& dbin);
+
+      // Best matches first
+      std::vector<result_t> query(const options_t& opts);
+  };
+}
+
+#endif /* SRDP_SEARCH_H */
@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "search.h"
+#include "journal.h"
+
+const std::filesystem::path search_db_path("test_search.db");
+
+static scas::Hash::hash_t make_hash(unsigned char c){
+  scas::Hash::hash_t hash;
+  hash.fill(c);
+  return hash;
+}
+
+TEST_CASE("Search quoting", "[search]") {
+  REQUIRE( srdp::Search::quote("") == "" );
+  REQUIRE( srdp::Search::quote("data.csv") == "\"data.csv\"" );
+  REQUIRE( srdp::Search::quote(" a  b ") == "\"a\" \"b\"" );
+  REQUIRE( srdp::Search::quote("temp*") == "\"temp\"*" );
+  REQUIRE( srdp::Search::quote("say\"hi") == "\"say\"\"hi\"" );
+}
+
+TEST_CASE("Full-text search", "[search]") {
+  std::filesystem::remove(search_db_path);
+  std::shared_ptr<srdp::Sql> db = std::make_shared<srdp::Sql>(search_db_path);
+
+  REQUIRE_NOTHROW( srdp::Project::create_table(*db) );
+  REQUIRE_NOTHROW( srdp::Experiment::create_table(*db) );
+  REQUIRE_NOTHROW( srdp::File::create_table(*db) );
+  REQUIRE_NOTHROW( srdp::Search::create_table(*db) );
+
+  srdp::Project p1(db, "alpha", true);
+  srdp::Project p2(db, "beta", true);
+  p1.metadata = "Study of the temperature dependence";
+  p1.update();
+
+  srdp::Experiment e1(db, p1, "run1", true);
+  srdp::Experiment e2(db, p2, "run2", true);
+
+  e1.append_journal("Used viscosity 0.3 for the solvent");
+  e2.append_journal("Solvent was water");
+  p2.append_journal("Budget report");
+
+  srdp::File f1(db, e1);
+  f1.hash = make_hash(1);
+  f1.size = 1;
+  f1.original_name = "input_water.csv";
+  f1.path = "data/input_water.csv";
+  f1.role = srdp::File::role_t::input;
+  f1.create();
+
+  srdp::File f2(db, e2);
+  f2.hash = make_hash(2);
+  f2.size = 1;
+  f2.original_name = "result.dat";
+  f2.metadata = "water density";
+  f2.path = "out/result.dat";
+  f2.role = srdp::File::role_t::output;
+  f2.create();
+
+  srdp::Search search(db);
+  srdp::Search::options_t opts;
+
+  auto count_kind = [](const std::vector<srdp::Search::result_t>& res, srdp::Search::kind_t kind) {
+    return std::count_if(res.begin(), res.end(), [kind](const auto& r) { return r.kind == kind; });
+  };
+
+  SECTION("Sources") {
+    opts.query = "temperature";
+    auto res = search.query(opts);
+    REQUIRE( res.size() == 1 );
+    REQUIRE( res[0].kind == srdp::Search::kind_t::project );
+    REQUIRE( res[0].project == "alpha" );
+    REQUIRE( res[0].snippet.find("[temperature]") != std::string::npos );
+
+    opts.query = "viscosity";
+    res = search.query(opts);
+    REQUIRE( res.size() == 1 );
+    REQUIRE( res[0].kind == srdp::Search::kind_t::journal );
+    REQUIRE( res[0].project == "alpha" );
+    REQUIRE( res[0].experiment == "run1" );
+
+    opts.query = "input_water.csv";
+    res = search.query(opts);
+    REQUIRE( count_kind(res, srdp::Search::kind_t::file) == 1 );
+    REQUIRE( count_kind(res, srdp::Search::kind_t::path) == 1 );
+    REQUIRE( res[0].hash == make_hash(1) );
+
+    opts.query = "budg*";
+    res = search.query(opts);
+    REQUIRE( res.size() == 1 );
+    REQUIRE( res[0].kind == srdp::Search::kind_t::journal );
+    REQUIRE_FALSE( res[0].experiment );
+  }
+
+  SECTION("Filters") {
+    opts.query = "water";
+    REQUIRE( search.query(opts).size() == 4 );
+
+    opts.project = p1.uuid;
+    auto res = search.query(opts);
+    REQUIRE( res.size() == 2 );
+    REQUIRE( count_kind(res, srdp::Search::kind_t::file) == 1 );
+    REQUIRE( count_kind(res, srdp::Search::kind_t::path) == 1 );
+
+    opts.project.reset();
+    opts.experiment = e2.uuid;
+    res = search.query(opts);
+    REQUIRE( res.size() == 2 );
+    REQUIRE( count_kind(res, srdp::Search::kind_t::journal) == 1 );
+    REQUIRE( count_kind(res, srdp::Search::kind_t::file) == 1 );
+
+    opts.experiment.reset();
+    opts.role = srdp::File::role_t::output;
+    res = search.query(opts);
+    REQUIRE( res.size() == 1 );
+    REQUIRE( res[0].hash == make_hash(2) );
+
+    opts.limit = 0;
+    REQUIRE( search.query(opts).empty() );
+  }
+
+  SECTION("Index follows changes") {
+    e1.name = "renamed";
+    e1.update();
+    opts.query = "renamed";
+    REQUIRE( search.query(opts).size() == 1 );
+
+    f1.unmap();
+    opts.query = "input_water";
+    REQUIRE( count_kind(search.query(opts), srdp::Search::kind_t::path) == 0 );
+
+    e2.journal().clear();
+    opts.query = "solvent";
+    REQUIRE( search.query(opts).size() == 1 );
+
+    e1.remove();
+    opts.query = "renamed";
+    REQUIRE( search.query(opts).empty() );
+  }
+
+  SECTION("Rebuild") {
+    REQUIRE_NOTHROW( srdp::Search::rebuild(*db) );
+    opts.query = "water";
+    REQUIRE( search.query(opts).size() == 4 );
+    opts.query = "viscosity";
+    REQUIRE( search.query(opts).size() == 1 );
+  }
+
+  SECTION("Invalid queries") {
+    opts.query = " ";
+    REQUIRE_THROWS( search.query(opts) );
+
+    opts.query = "AND (";
+    opts.raw = true;
+    REQUIRE_THROWS( search.query(opts) );
+  }
+
+  std::filesystem::remove(search_db_path);
+}
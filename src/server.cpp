@@ -0,0 +1,258 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdio>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+#include "server.h"
+#include "unix_socket.h"
+
+namespace srdp {
+
+  const fs::path Server::socket_name = "serve.sock";
+  const size_t Server::max_request_size = 1 << 20;
+
+  namespace {
+    std::string reply(bool ok, const std::string& message){
+      std::string line(ok ? "ok\t" : "error\t");
+      for (char c : message) {
+        if (c == '\\') line += "\\\\";
+        else if (c == '\n') line += "\\n";
+        else if (c == '\t') line += "\\t";
+        else if (c == '\r') line += "\\r";
+        else line += c;
+      }
+      return line + "\n";
+    }
+
+    std::string unescape(const std::string& text){
+      std::string out;
+      for (size_t i=0; i < text.size(); i++) {
+        if (text[i] != '\\' || i + 1 == text.size()) {
+          out += text[i];
+          continue;
+        }
+        switch (text[++i]) {
+          case 'n': out += '\n'; break;
+          case 't': out += '\t'; break;
+          case 'r': out += '\r'; break;
+          default:  out += text[i];
+        }
+      }
+      return out;
+    }
+
+    // Request line as JSON array, see Batch::split
+    std::string json_array(const std::vector<std::string>& args){
+      std::string line("[");
+      for (size_t i=0; i < args.size(); i++) {
+        if (i > 0) line += ',';
+        line += '"';
+        for (unsigned char c : args[i]) {
+          if (c == '"') line += "\\\"";
+          else if (c == '\\') line += "\\\\";
+          else if (c == '\n') line += "\\n";
+          else if (c == '\t') line += "\\t";
+          else if (c == '\r') line += "\\r";
+          else if (c < 0x20) {
+            char code[7];
+            std::snprintf(code, sizeof(code), "\\u%04x", c);
+            line += code;
+          } else
+            line += c;
+        }
+        line += '"';
+      }
+      return line + "]\n";
+    }
+  }
+
+  Server::Server(Srdp& srdpin) :
+    srdp(srdpin),
+    socket_path(srdpin.get_cfg_dir() / socket_name)
+  {
+    try {
+      listen_fd = unix_socket::listen(socket_path, "Server");
+
+      wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if (wake_fd == -1)
+        throw std::system_error(errno, std::system_category(), "Can not create eventfd");
+    } catch (...) {
+      close_all();
+      throw;
+    }
+  }
+
+  Server::~Server(){
+    close_all();
+  }
+
+  void Server::close_all(){
+    for (const auto& c : clients)
+      close(c.fd);
+    clients.clear();
+
+    if (listen_fd != -1) {
+      close(listen_fd);
+      listen_fd = -1;
+      std::error_code ec;
+      fs::remove(socket_path, ec);
+    }
+    if (wake_fd != -1) {
+      close(wake_fd);
+      wake_fd = -1;
+    }
+  }
+
+  std::string Server::handle(const std::string& request){
+    std::vector<std::string> args;
+    try {
+      args = Batch::split(request);
+    } catch (std::exception& e) {
+      return reply(false, e.what());
+    }
+
+    // Selection for this request only
+    std::string project;
+    std::string experiment;
+    size_t first = 0;
+    while (first + 1 < args.size()) {
+      if (args[first] == "--project")
+        project = args[first + 1];
+      else if (args[first] == "--experiment")
+        experiment = args[first + 1];
+      else
+        break;
+      first += 2;
+    }
+    args.erase(args.begin(), args.begin() + first);
+
+    if (args.size() == 1 && args[0] == "ping")
+      return reply(true, "pong");
+
+    try {
+      Batch batch(srdp, 1, project, experiment);
+      const auto r = batch.run_command(args);
+      return reply(r.ok, r.message);
+    } catch (std::exception& e) {
+      // e.g. the DB is locked by another process
+      return reply(false, e.what());
+    }
+  }
+
+  bool Server::read_client(client_t& client){
+    char buffer[64 * 1024];
+    const ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+    if (n == -1) return errno == EINTR;
+    if (n == 0) return false;
+
+    client.input.append(buffer, n);
+
+    size_t start = 0;
+    for (size_t end; (end = client.input.find('\n', start)) != std::string::npos; start = end + 1) {
+      if (!unix_socket::send_all(client.fd, handle(client.input.substr(start, end - start))))
+        return false;
+    }
+    client.input.erase(0, start);
+
+    return client.input.size() <= max_request_size;
+  }
+
+  void Server::run(){
+    std::vector<struct pollfd> fds;
+
+    while (true) {
+      fds.assign({{wake_fd, POLLIN, 0}, {listen_fd, POLLIN, 0}});
+      for (const auto& c : clients)
+        fds.push_back({c.fd, POLLIN, 0});
+
+      if (poll(fds.data(), fds.size(), -1) == -1) {
+        if (errno == EINTR) continue;
+        throw std::system_error(errno, std::system_category(), "Can not poll");
+      }
+
+      if (fds[0].revents) break;
+
+      // Clients are served in order, a slow client only delays the others
+      for (size_t i = clients.size(); i-- > 0;) {
+        const short revents = fds[i + 2].revents;
+        if (!revents) continue;
+
+        bool keep = false;
+        try {
+          keep = (revents & POLLIN) && read_client(clients[i]);
+        } catch (const std::exception& e) {
+          std::cerr << "Error: " << e.what() << "\n";
+        }
+
+        if (!keep) {
+          close(clients[i].fd);
+          clients.erase(clients.begin() + i);
+        }
+      }
+
+      if (fds[1].revents & POLLIN) {
+        const int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd == -1) continue;
+
+        unix_socket::set_timeout(fd, 5);
+        clients.push_back({fd, std::string()});
+      }
+    }
+  }
+
+  void Server::stop(){
+    const uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = write(wake_fd, &one, sizeof(one));
+  }
+
+  std::optional<Batch::result_t> Server::request(const std::vector<std::string>& args,
+      const std::string& project, const std::string& experiment, const fs::path& start){
+
+    // Find the config directory like Srdp, but without opening the DB
+    fs::path dir;
+    try {
+      dir = Srdp::find_top_level_dir(start);
+    } catch (std::exception& e) {
+      return std::nullopt;
+    }
+
+    const int fd = unix_socket::connect(dir / Srdp::cfg_dir / socket_name);
+    if (fd == -1) return std::nullopt;
+
+    unix_socket::set_timeout(fd, 60);
+
+    std::vector<std::string> request;
+    if (!project.empty()) request.insert(request.end(), {"--project", project});
+    if (!experiment.empty()) request.insert(request.end(), {"--experiment", experiment});
+    request.insert(request.end(), args.begin(), args.end());
+
+    std::string answer;
+    if (unix_socket::send_all(fd, json_array(request))) {
+      char buffer[4096];
+      while (answer.find('\n') == std::string::npos) {
+        const ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0) break;
+        answer.append(buffer, n);
+      }
+    }
+    close(fd);
+
+    // The command may have been run, it must not be repeated in-process
+    const size_t end = answer.find('\n');
+    const size_t tab = answer.find('\t');
+    if (end == std::string::npos || tab > end)
+      throw std::runtime_error("No answer from dp serve");
+
+    const std::string status = answer.substr(0, tab);
+    if (status != "ok" && status != "error")
+      throw std::runtime_error("Invalid answer from dp serve");
+
+    return Batch::result_t{0, status == "ok", unescape(answer.substr(tab + 1, end - tab - 1))};
+  }
+}
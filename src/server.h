@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_SERVER_H
+#define SRDP_SERVER_H
+
+#include <optional>
+
+#include "batch.h"
+
+namespace srdp {
+
+  /**
+   * Command server (dp serve).
+   *
+   * Keeps one Srdp open, i.e. the DB connection, the config snapshot,
+   * and the resolved projects and experiments, and runs the commands of
+   * dp batch for clients connected to a Unix socket in the config
+   * directory. Changes made by other processes are picked up through
+   * the DB data version.
+   *
+   * Protocol: every request is one line with a command as in dp batch,
+   * optionally preceded by "--project <name>" and "--experiment <name>",
+   * or "ping". Every request is answered by one line "ok\t<message>" or
+   * "error\t<message>", with backslash, tab, and newline escaped as in TSV.
+   * A client can send any number of requests over one connection.
+   */
+  class Server {
+    private:
+      struct client_t {
+        int fd;
+        std::string input; // incomplete request
+      };
+
+      Srdp& srdp;
+      fs::path socket_path;
+
+      int listen_fd = -1;
+      int wake_fd = -1;
+      std::vector<client_t> clients;
+
+      void close_all();
+
+      // Returns false if the connection is to be closed
+      bool read_client(client_t& client);
+
+    public:
+      static const fs::path socket_name;
+      static const size_t max_request_size;
+
+      /* Bind the socket.
+       *
+       * Throws if another server is already running.
+       */
+      Server(Srdp& srdp);
+      ~Server();
+
+      Server(const Server&) = delete;
+      Server& operator=(const Server&) = delete;
+
+      // Answer to a single request line, including the line end
+      std::string handle(const std::string& request);
+
+      // Serve clients until stop() is called
+      void run();
+
+      // Can be called from another thread or a signal handler
+      void stop();
+
+      /**
+       * Run a command in the server of the project directory containing start.
+       *
+       * The DB is not opened. Returns nothing if no server is running,
+       * throws if the server does not answer.
+       */
+      static std::optional<Batch::result_t> request(const std::vector<std::string>& args,
+          const std::string& project = std::string(), const std::string& experiment = std::string(),
+          const fs::path& start = fs::current_path());
+  };
+}
+
+#endif /* SRDP_SERVER_H */
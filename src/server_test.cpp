@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <fstream>
+#include <thread>
+#include <catch2/catch_test_macros.hpp>
+
+#include "server.h"
+
+TEST_CASE("Command server", "[server]") {
+  const fs::path base_dir = fs::absolute("test_server");
+  auto old_cwd = fs::current_path();
+
+  fs::remove_all(base_dir);
+  fs::create_directory(base_dir);
+  fs::current_path(base_dir);
+
+  REQUIRE_NOTHROW( srdp::Srdp::init("./") );
+
+  srdp::Srdp dp;
+  REQUIRE_NOTHROW( dp.create_project("project") );
+  fs::create_directory("sub");
+  std::ofstream("sub/a") << "a";
+
+  // No server running
+  REQUIRE_FALSE( srdp::Server::request({"ping"}) );
+
+  {
+    // The server thread uses its own DB connection
+    srdp::Srdp dp_serve;
+    srdp::Server server(dp_serve);
+
+    // Only one server per project
+    REQUIRE_THROWS( srdp::Server(dp) );
+
+    std::thread thread([&server]() { server.run(); });
+    struct stop_t {
+      srdp::Server& server;
+      std::thread& thread;
+      ~stop_t() { server.stop(); thread.join(); }
+    } stop{server, thread};
+
+    auto r = srdp::Server::request({"ping"});
+    REQUIRE( r );
+    REQUIRE( r->ok );
+    REQUIRE( r->message == "pong" );
+
+    // Found from a subdirectory
+    r = srdp::Server::request({"experiment", "create", "e1"}, "", "", "sub");
+    REQUIRE( r );
+    REQUIRE( r->ok );
+    REQUIRE( dp.open_experiment("e1").name == "e1" );
+
+    // Messages keep special characters
+    r = srdp::Server::request({"experiment", "abstract", "two\nlines\tand \"quotes\""}, "project", "e1");
+    REQUIRE( r );
+    REQUIRE( r->ok );
+    REQUIRE( *dp.open_experiment("e1").metadata == "two\nlines\tand \"quotes\"" );
+
+    r = srdp::Server::request({"file", "add", "input", fs::absolute("sub/a").string()}, "", "e1");
+    REQUIRE( r );
+    REQUIRE( r->ok );
+    REQUIRE( dp.get_file("", "e1").list().size() == 1 );
+
+    // Errors are reported, the server keeps running
+    r = srdp::Server::request({"experiment", "set", "missing"});
+    REQUIRE( r );
+    REQUIRE_FALSE( r->ok );
+
+    r = srdp::Server::request({"nonsense"});
+    REQUIRE( r );
+    REQUIRE_FALSE( r->ok );
+
+    // Changes of other connections are visible to the server
+    dp.create_experiment("e2");
+    REQUIRE( srdp::Server::request({"experiment", "set", "e2"})->ok );
+    REQUIRE( dp.open_experiment().name == "e2" );
+
+    // From outside the project only an explicit start finds the server (dp -d)
+    fs::current_path(old_cwd);
+    REQUIRE_FALSE( srdp::Server::request({"ping"}) );
+    r = srdp::Server::request({"experiment", "set", "e1"}, "", "", base_dir / "sub");
+    fs::current_path(base_dir);
+    REQUIRE( r );
+    REQUIRE( r->ok );
+    REQUIRE( dp.open_experiment().name == "e1" );
+    REQUIRE( srdp::Server::request({"experiment", "set", "e2"})->ok );
+
+    // Requests as JSON array or as words
+    REQUIRE( server.handle("[\"ping\"]") == "ok\tpong\n" );
+    REQUIRE( server.handle("--experiment e1 experiment append 'a\\b'") == "ok\tjournal of e1 appended\n" );
+    REQUIRE( server.handle("['x'").rfind("error\t", 0) == 0 );
+  }
+
+  // Socket is removed on exit
+  REQUIRE_FALSE( fs::exists(dp.get_cfg_dir() / srdp::Server::socket_name) );
+  REQUIRE_FALSE( srdp::Server::request({"ping"}) );
+
+  fs::current_path(old_cwd);
+  REQUIRE_NOTHROW( fs::remove_all(base_dir) );
+}
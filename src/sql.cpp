@@ -3,8 +3,15 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "sql.h"
+#include "timings.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <sstream>
 #include <assert.h>
 
 
@@ -20,6 +27,166 @@ namespace srdp {
     return blob;
   }
 
+  const size_t Sql::statement_cache_size = 64;
+
+  static Sql::hook_t statement_hook;
+
+  void Sql::set_hook(hook_t hook){
+    statement_hook = std::move(hook);
+  }
+
+  // Profiler, shared by all connections
+  static std::atomic<bool> profiler_enabled(false);
+  static std::once_flag profiler_exit_once;
+  static size_t profiler_top = 0;
+  static std::mutex profile_mutex;
+  static std::map<std::string, Sql::profile_t> profile;
+
+  void Sql::enable_profiler(size_t top){
+    if (top > 0) {
+      profiler_top = top;
+      std::call_once(profiler_exit_once, []() {
+          std::atexit([]() { if (profiler_enabled) print_profile(std::cerr, profiler_top); });
+        });
+    }
+
+    profiler_enabled = true;
+  }
+
+  void Sql::disable_profiler(){
+    profiler_enabled = false;
+  }
+
+  bool Sql::is_profiling(){
+    return profiler_enabled;
+  }
+
+  std::map<std::string, Sql::profile_t> Sql::get_profile(){
+    std::lock_guard<std::mutex> lock(profile_mutex);
+    return profile;
+  }
+
+  std::string Sql::normalize(std::string_view sql){
+    auto is_word = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; };
+
+    std::string result;
+    result.reserve(sql.size());
+    bool space = false;
+
+    for (size_t i=0; i < sql.size(); i++) {
+      const char c = sql[i];
+
+      if (std::isspace(static_cast<unsigned char>(c))) {
+        space = !result.empty();
+        continue;
+      }
+
+      if (space) {
+        result += ' ';
+        space = false;
+      }
+
+      if (c == '\'') {
+        // String literal, '' is an escaped quote
+        size_t j = i + 1;
+        while (j < sql.size()) {
+          if (sql[j] == '\'' && j + 1 < sql.size() && sql[j + 1] == '\'') j += 2;
+          else if (sql[j] == '\'') break;
+          else j++;
+        }
+        result += '?';
+        i = j;
+      } else if (std::isdigit(static_cast<unsigned char>(c)) && (result.empty() || !is_word(result.back()))) {
+        // Number literal, not part of a name
+        while (i + 1 < sql.size() && (is_word(sql[i + 1]) || sql[i + 1] == '.')) i++;
+        result += '?';
+      } else {
+        result += c;
+      }
+    }
+
+    return result;
+  }
+
+  static int64_t ns_since(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  // Add one run of a statement to the profile
+  static void record_profile(sqlite3_stmt* statement, int64_t ns, uint64_t rows){
+    const char* text = sqlite3_sql(statement);
+    const std::string key = Sql::normalize(text ? text : "");
+
+    // Counters are reset for the next run of the statement
+    const int fullscan = sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+    const int sorts = sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_SORT, 1);
+    const int autoindexes = sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+    const int vm_steps = sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_VM_STEP, 1);
+
+    std::lock_guard<std::mutex> lock(profile_mutex);
+    auto& entry = profile[key];
+    entry.calls++;
+    entry.total_ns += ns;
+    entry.max_ns = std::max(entry.max_ns, ns);
+    entry.rows += rows;
+    entry.fullscan_steps += fullscan;
+    entry.sorts += sorts;
+    entry.autoindexes += autoindexes;
+    entry.vm_steps += vm_steps;
+  }
+
+  int Sql::trace_profile(unsigned type, void* context, void* p, void* x){
+    if (type != SQLITE_TRACE_PROFILE || !profiler_enabled) return 0;
+
+    auto self = static_cast<Sql*>(context);
+    auto statement = static_cast<sqlite3_stmt*>(p);
+
+    // Statements stepped through this object are recorded with their
+    // own time in SQLite when finalized or reset, see profile_statement
+    if (statement == self->stmt) return 0;
+
+    // Statements of exec. SQLite measures them in milliseconds, from the
+    // first step until they finish.
+    record_profile(statement, *static_cast<sqlite3_int64*>(x), 0);
+
+    return 0;
+  }
+
+  void Sql::profile_statement(){
+    if (stmt != nullptr && profiler_enabled)
+      record_profile(stmt, stmt_ns, rows_stepped);
+
+    rows_stepped = 0;
+    stmt_ns = 0;
+  }
+
+  void Sql::print_profile(std::ostream& out, size_t top){
+    const auto entries = get_profile();
+
+    std::vector<std::pair<std::string, profile_t>> sorted(entries.begin(), entries.end());
+    std::stable_sort(sorted.begin(), sorted.end(),
+        [](const auto& a, const auto& b) { return a.second.total_ns > b.second.total_ns; });
+
+    if (sorted.size() > top) sorted.resize(top);
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(3);
+    report << "SQL profile (top " << sorted.size() << " of " << entries.size() << " statements by total time):\n";
+    report << std::setw(8) << "calls" << std::setw(12) << "total ms" << std::setw(10) << "max ms"
+      << std::setw(10) << "rows" << std::setw(10) << "fullscan" << std::setw(7) << "sorts"
+      << std::setw(9) << "autoidx" << std::setw(12) << "vm steps" << "  statement\n";
+
+    for (const auto& [sql, p] : sorted) {
+      const std::string text = sql.size() > 100 ? sql.substr(0, 97) + "..." : sql;
+      report << std::setw(8) << p.calls << std::setw(12) << double(p.total_ns) / 1e6
+        << std::setw(10) << double(p.max_ns) / 1e6 << std::setw(10) << p.rows
+        << std::setw(10) << p.fullscan_steps << std::setw(7) << p.sorts
+        << std::setw(9) << p.autoindexes << std::setw(12) << p.vm_steps << "  " << text << "\n";
+    }
+
+    out << report.str();
+  }
+
   Sql::Sql(const fs::path& dbfile) : stmt(nullptr), db(nullptr) {
     int ret = sqlite3_open(std::string(dbfile).c_str(), &db);
 
@@ -29,18 +196,28 @@ namespace srdp {
       throw std::runtime_error("Can not open sqlite database: "  + msg);
     }
 
+    if (profiler_enabled)
+      sqlite3_trace_v2(db, SQLITE_TRACE_PROFILE, trace_profile, this);
+
     query("PRAGMA foreign_keys = 1;");
   }
 
   Sql::~Sql(){
+    profile_statement();
     sqlite3_finalize(stmt);
     stmt = nullptr;
+
+    for (auto& cached : statement_cache)
+      sqlite3_finalize(cached.second);
+    statement_cache.clear();
+
     flush();
     sqlite3_close(db);
     db = nullptr;
   }
 
   void Sql::db_error(const std::string& msg){
+    profile_statement();
     sqlite3_finalize(stmt);
     stmt = nullptr;
     std::string sql_err(sqlite3_errmsg(db));
@@ -54,6 +231,10 @@ namespace srdp {
   }
 
   void Sql::exec(const std::string& sql){
+    Timings::Span span("sql.exec");
+    Timings::add(Timings::counter_t::queries);
+    if (statement_hook) statement_hook(sql);
+
     char* errmsg = nullptr;
     int rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errmsg);
 
@@ -64,24 +245,49 @@ namespace srdp {
   void Sql::prepare(const std::string& sql){
     if (stmt != nullptr) finalize();
 
+    Timings::add(Timings::counter_t::queries);
+    if (statement_hook) statement_hook(sql);
+
+    // Reset and unbound by finalize
+    auto cached = statement_cache.find(sql);
+    if (cached != statement_cache.end()) {
+      stmt = cached->second;
+      statement_cache.erase(cached);
+      stmt_sql = sql;
+      return;
+    }
+
+    const bool profiling = profiler_enabled;
+    const auto start = profiling ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
     int ret = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+    if (profiling) stmt_ns = ns_since(start);
     if (ret != SQLITE_OK)
       db_error("prepare failed");
+
+    stmt_sql = sql;
   };
 
   bool Sql::step_row(){
-    if (stmt == nullptr)
-      throw std::runtime_error("No open SQL Query");
-
-    int res = sqlite3_step(stmt);
-    return res == SQLITE_ROW;
+    return step() == SQLITE_ROW;
   }
 
   int Sql::step(){
     if (stmt == nullptr)
       throw std::runtime_error("No open SQL Query");
 
-    return sqlite3_step(stmt);
+    const bool profiling = profiler_enabled;
+    const auto start = profiling ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
+    int res = sqlite3_step(stmt);
+    if (profiling) stmt_ns += ns_since(start);
+
+    if (res == SQLITE_ROW) {
+      rows_stepped++;
+      Timings::add(Timings::counter_t::rows);
+    }
+
+    return res;
   }
 
   int Sql::column_count(){
@@ -92,16 +298,37 @@ namespace srdp {
   }
 
   void Sql::finalize(){
-    if (stmt != nullptr) {
-      if (sqlite3_finalize(stmt) != SQLITE_OK){
-        stmt = nullptr;
-        throw std::runtime_error("sqlite3_finalize failed");
-      }
-    }
+    profile_statement();
+
+    if (stmt == nullptr) return;
+
+    sqlite3_stmt* done = stmt;
     stmt = nullptr;
+
+    // Reports the error of the last step like sqlite3_finalize
+    if (sqlite3_reset(done) != SQLITE_OK) {
+      sqlite3_finalize(done);
+      throw std::runtime_error("sqlite3_finalize failed");
+    }
+    sqlite3_clear_bindings(done);
+
+    if (statement_cache.count(stmt_sql)) {
+      sqlite3_finalize(done);
+      return;
+    }
+
+    if (statement_cache.size() >= statement_cache_size) {
+      sqlite3_finalize(statement_cache.begin()->second);
+      statement_cache.erase(statement_cache.begin());
+    }
+
+    statement_cache.emplace(std::move(stmt_sql), done);
+    stmt_sql.clear();
   }
 
   void Sql::reset(){
+    profile_statement();
+
     if (stmt != nullptr) {
       if (sqlite3_reset(stmt) != SQLITE_OK){
         stmt = nullptr;
@@ -216,6 +443,17 @@ namespace srdp {
     return res;
   }
 
+  std::optional<std::string_view> Sql::get_column_view(int column){
+    if (column_count() < column) return {};
+    if (sqlite3_column_type(stmt, column) == SQLITE_NULL) return {};
+
+    // Blob pointer first, bytes must be asked after the conversion
+    const char* data = static_cast<const char*>(sqlite3_column_blob(stmt, column));
+    const int nbytes = sqlite3_column_bytes(stmt, column);
+
+    return std::string_view(data, nbytes);
+  }
+
   std::optional<bool> Sql::get_column_bool(int column){
     if (column_count() < column) return {};
     int nbytes = sqlite3_column_bytes(stmt, column);
@@ -225,11 +463,41 @@ namespace srdp {
   }
 
   std::optional<Sql::vec_sql_opt_t> Sql::query(const std::string& sql_query, const vec_sql_t& bindings, const vec_sql_t& result_types){
+    Timings::Span span("sql.query");
+    finalize(); // clear any previous statement
+
+    prepare(sql_query);
+    bind(bindings);
+
+    if (result_types.size() > 0)
+      row_result_types = result_types;
+
+    return next_row();
+  }
+
+  void Sql::for_each_row(const std::string& sql_query, const vec_sql_t& bindings, const std::function<void(Sql& row)>& row){
+    Timings::Span span("sql.for_each_row");
     finalize(); // clear any previous statement
 
     prepare(sql_query);
+    bind(bindings);
+
+    try {
+      int rc;
+      while ((rc = step()) == SQLITE_ROW)
+        row(*this);
+
+      if (rc != SQLITE_DONE)
+        db_error("step failed");
+    } catch (...) {
+      finalize();
+      throw;
+    }
 
-    // Bind all parameters
+    finalize();
+  }
+
+  void Sql::bind(const vec_sql_t& bindings){
     for (size_t i=0; i < bindings.size(); i++){
       auto bind = bindings[i];
       if (std::holds_alternative<int>(bind))
@@ -246,14 +514,10 @@ namespace srdp {
         bind_null(i+1);
       else assert (false); // should never happen
     }
-
-    if (result_types.size() > 0)
-      row_result_types = result_types;
-
-    return next_row();
   }
 
   std::optional<Sql::vec_sql_opt_t> Sql::next_row(){
+    Timings::Span span("sql.next_row");
     if (step_row()) {
       if (row_result_types.size() > 0 && column_count() != row_result_types.size())
         throw std::invalid_argument("Number of columns expected do not match number of columns");
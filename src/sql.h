@@ -5,10 +5,15 @@
 #ifndef SRDP_SQL_H
 #define SRDP_SQL_H
 
+#include <chrono>
 #include <string>
 #include <filesystem>
+#include <map>
+#include <ostream>
 #include <vector>
 #include <optional>
+#include <string_view>
+#include <unordered_map>
 #include <variant>
 #include <functional>
 
@@ -31,6 +36,21 @@ namespace srdp {
       using vec_sql_t = std::vector<sql_t>;
       using vec_sql_opt_t = std::vector<std::optional<sql_t>>;
 
+      // Receives the text of each statement
+      using hook_t = std::function<void(const std::string& sql)>;
+
+      // Profile of one normalized statement
+      struct profile_t {
+        uint64_t calls = 0;
+        int64_t total_ns = 0;
+        int64_t max_ns = 0;
+        uint64_t rows = 0;
+        uint64_t fullscan_steps = 0;  // steps of full table scans
+        uint64_t sorts = 0;
+        uint64_t autoindexes = 0;     // rows inserted into automatic indexes
+        uint64_t vm_steps = 0;
+      };
+
       template <class T>
       static std::optional<T> sql_repack_optional(const std::optional<sql_t>& value){
         if (value)
@@ -67,6 +87,17 @@ namespace srdp {
       sqlite3* db;
       sqlite3_stmt* stmt;
       vec_sql_t row_result_types;
+      // Of stmt, for the profiler: rows and time spent in prepare and step
+      uint64_t rows_stepped = 0;
+      int64_t stmt_ns = 0;
+
+      // Finished statements by their text, reused by prepare
+      std::unordered_map<std::string, sqlite3_stmt*> statement_cache;
+      std::string stmt_sql; // text stmt was prepared from
+      static const size_t statement_cache_size;
+
+      static int trace_profile(unsigned type, void* context, void* p, void* x);
+      void profile_statement();
 
       void db_error(const std::string& msg);
       void db_error(const std::string& msg, char* errmsg);
@@ -75,7 +106,33 @@ namespace srdp {
       Sql(const fs::path& dbfile);
       ~Sql();
 
+      /* Set a hook that is called before any connection prepares or
+       * executes a statement, e.g. to count queries in tests.
+       * Calls may come from several threads. Set it only while no
+       * statements run, an empty hook removes it.
+       */
+      static void set_hook(hook_t hook);
+
+      /* Profile the statements of connections opened from now on.
+       *
+       * Statements are aggregated by their normalized text. If top is
+       * not 0, the top statements by total time are printed to stderr
+       * at exit.
+       */
+      static void enable_profiler(size_t top = 0);
+      static void disable_profiler();
+      static bool is_profiling();
+
+      static std::map<std::string, profile_t> get_profile();
+
+      // Print the top statements by total time
+      static void print_profile(std::ostream& out, size_t top);
+
+      // Collapse white space and replace literals by ?
+      static std::string normalize(std::string_view sql);
+
       bool is_open() { return db; }
+      size_t cached_statements() const { return statement_cache.size(); }
       // High level functions
       std::optional<Sql::vec_sql_opt_t> query(
           const std::string& sql_query,
@@ -84,9 +141,22 @@ namespace srdp {
 
       std::optional<vec_sql_opt_t> next_row();
 
+      /**
+       * Step through all rows without copying them.
+       * row is called for each row and reads the columns with the
+       * get_column_* functions. It must not run other queries.
+       */
+      void for_each_row(
+          const std::string& sql_query,
+          const vec_sql_t& bindings,
+          const std::function<void(Sql& row)>& row);
+
       void exec(const std::string& sql);
 
       // Low level functions
+
+      // Statements are kept after finalize and reused when the same
+      // text is prepared again
       void prepare(const std::string& sql);
 
       bool step_row();
@@ -96,6 +166,7 @@ namespace srdp {
       void clear_bindings();
       void flush();
       int column_count();
+      void bind(const vec_sql_t& bindings);
 
       void bind_int(int index, int value);
       void bind_int64(int index, int64_t value);
@@ -109,6 +180,8 @@ namespace srdp {
       std::optional<std::string> get_column_str(int column);
       std::optional<std::vector<unsigned char>> get_column_blob(int column);
       std::optional<bool> get_column_bool(int column);
+      // Text or blob bytes, valid until the next step
+      std::optional<std::string_view> get_column_view(int column);
 
   };
 
@@ -3,6 +3,9 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "sql.h"
+#include <chrono>
+#include <sstream>
+#include <thread>
 #include <catch2/catch_test_macros.hpp>
 
 TEST_CASE("One-shot interface","[sql]") {
@@ -163,5 +166,65 @@ TEST_CASE("High level query", "[sql]"){
 
   REQUIRE ( !db.next_row() );
 
+  // Statements are reused with new bindings
+  const size_t cached = db.cached_statements();
+  res = db.query(sql_select, srdp::Sql::vec_sql_t{"Bob"}, srdp::Sql::vec_sql_t{int(0), std::string()});
+  REQUIRE( res );
+  REQUIRE( std::get<int>(*((*res)[0])) == 2);
+  REQUIRE ( !db.next_row() );
+  REQUIRE( db.cached_statements() == cached );
+
+  // Unfinished statements are reset before reuse
+  REQUIRE( db.query("SELECT string FROM mytable ORDER BY id;", {}, srdp::Sql::vec_sql_t{std::string()}) );
+  res = db.query("SELECT string FROM mytable ORDER BY id;", {}, srdp::Sql::vec_sql_t{std::string()});
+  REQUIRE( std::get<std::string>(*((*res)[0])) == "Alice");
+
   std::filesystem::remove("highlevel.db");
 }
+
+TEST_CASE("Statement profiler", "[sql]"){
+  REQUIRE( srdp::Sql::normalize("  SELECT a1,  b FROM t\n  WHERE x = 'it''s' AND y = 4.5;  ")
+      == "SELECT a1, b FROM t WHERE x = ? AND y = ?;" );
+  REQUIRE( srdp::Sql::normalize("INSERT INTO t VALUES(X'00ff', 12)") == "INSERT INTO t VALUES(X?, ?)" );
+
+  srdp::Sql::enable_profiler();
+  {
+    srdp::Sql db("profile.db");
+    db.exec("CREATE TABLE IF NOT EXISTS items (id INTEGER PRIMARY KEY, name TEXT);");
+    db.exec("DELETE FROM items;");
+    for (int i=0; i < 20; i++)
+      db.query("INSERT INTO items (name) VALUES (?);", srdp::Sql::vec_sql_t{"n" + std::to_string(i)});
+
+    // Unindexed lookup, time spent in the visitor does not count
+    int rows = 0;
+    db.for_each_row("SELECT id FROM items WHERE name = ?;", srdp::Sql::vec_sql_t{"n3"}, [&](srdp::Sql&) {
+        rows++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      });
+    REQUIRE( rows == 1 );
+  }
+  srdp::Sql::disable_profiler();
+
+  const auto profile = srdp::Sql::get_profile();
+
+  const auto insert = profile.find("INSERT INTO items (name) VALUES (?);");
+  REQUIRE( insert != profile.end() );
+  REQUIRE( insert->second.calls == 20 );
+  REQUIRE( insert->second.total_ns > 0 );
+  REQUIRE( insert->second.max_ns <= insert->second.total_ns );
+
+  const auto select = profile.find("SELECT id FROM items WHERE name = ?;");
+  REQUIRE( select != profile.end() );
+  REQUIRE( select->second.calls == 1 );
+  REQUIRE( select->second.rows == 1 );
+  REQUIRE( select->second.total_ns > 0 );
+  REQUIRE( select->second.total_ns < 50000000 );
+  REQUIRE( select->second.fullscan_steps > 0 );
+  REQUIRE( select->second.vm_steps > 0 );
+
+  std::ostringstream out;
+  srdp::Sql::print_profile(out, 1);
+  REQUIRE( out.str().find("top 1 of") != std::string::npos );
+
+  std::filesystem::remove("profile.db");
+}
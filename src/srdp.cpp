@@ -2,56 +2,60 @@
 //
 // SPDX-License-Identifier: GPL-3.0-only
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_set>
 #include <unistd.h>
 #include <pwd.h>
+#include <dirent.h>
+#include <fcntl.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <boost/uuid/uuid_io.hpp>
 #include "srdp.h"
+#include "dir_walker.h"
+#include "workspace_index.h"
+#include "sys_calls.h"
+#include "timings.h"
 
 
 namespace srdp {
 
-  const std::string Srdp::db_schema_version = "1";
+  const std::string Srdp::db_schema_version = "6";
   const fs::path Srdp::cfg_dir = ".srdp";
   const fs::path Srdp::db_file = "project.db";
   const fs::path Srdp::ignore_file_name = ".srdpignore";
+  const fs::path Srdp::gitignore_file_name = ".gitignore";
   const fs::path Srdp::default_store_dir = "store";
+  const fs::path Srdp::index_file_name = "index";
+  const char* Srdp::top_level_dir_env = "SRDP_TOP_LEVEL_DIR";
 
-  Srdp::Srdp() :
-    ignore_matcher(ignore_file_name)
+  Srdp::Srdp()
   {
-    init_();
+    init_(fs::current_path());
   }
 
   Srdp::Srdp(const fs::path& project_path, bool interactive) :
-    interactive(interactive),
-    ignore_matcher(ignore_file_name)
+    interactive(interactive)
   {
-    init_();
+    init_(project_path);
   }
 
-  void Srdp::init_() {
-    top_level_dir = find_top_level_dir(fs::current_path());
-    db = std::make_shared<Sql>(top_level_dir / cfg_dir / db_file);
-
-    if (!db)
-      throw std::runtime_error("Invalid DB pointer.");
-
-    config = Config(db);
-    check_db_schema_version();
+  void Srdp::init_(const fs::path& start) {
+    top_level_dir = find_top_level_dir(start);
     if (!isatty(0)) interactive = false;
-
-    // let the matcher ignore our internal files automatically
-    ignore_matcher.add_pattern(cfg_dir.filename().string() + "/");
-    ignore_matcher.add_pattern(ignore_file_name.filename().string());
   }
 
   //
   // Static members
   //
-  void Srdp::init(const fs::path& dir, const fs::path& store_dir){
+  void Srdp::init(const fs::path& dir, const fs::path& store_dir, bool use_gitignore){
     if (fs::exists(dir) && !fs::is_directory(dir))
       throw std::invalid_argument("Target is not a directory");
 
@@ -69,9 +73,12 @@ namespace srdp {
     Experiment::create_table(*db);
     File::create_table(*db);
     Config::create_table(*db);
+    VerifyState::create_table(*db);
+    Search::create_table(*db);
 
     Config cfg(db);
     cfg.set_string("db_schema_version", db_schema_version);
+    cfg.set_use_gitignore(use_gitignore);
 
     fs::path final_store_dir;
 
@@ -110,14 +117,134 @@ namespace srdp {
   // Private members
   //
 
-  void Srdp::check_db_schema_version(){
-    if (config.get_string("db_schema_version") != "1")
+  Srdp::session_t& Srdp::session(){
+    std::unique_lock<std::mutex> lock(sessions_mutex);
+
+    auto& s = sessions[std::this_thread::get_id()];
+    if (!s) {
+      auto db = std::make_shared<Sql>(top_level_dir / cfg_dir / db_file);
+
+      // Wait for the writer of another thread or process
+      db->exec("PRAGMA busy_timeout = 10000;");
+
+      s = std::make_unique<session_t>();
+      s->db = db;
+      s->config = Config(db);
+    }
+
+    session_t* current = s.get();
+    lock.unlock();
+
+    // The first connection prepares the DB, the others wait for it
+    if (!db_checked.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> check_lock(db_check_mutex);
+      if (!db_checked.load(std::memory_order_relaxed)) {
+        // Readers do not block the writer (stored in the DB file)
+        current->db->exec("PRAGMA journal_mode = WAL;");
+        check_db_schema_version(*current);
+        db_checked.store(true, std::memory_order_release);
+      }
+    }
+
+    return *current;
+  }
+
+  void Srdp::load_ignore_rules(){
+    std::call_once(ignore_loaded, [this]() {
+      // Ignore files in each directory, .srdpignore takes precedence
+      std::vector<fs::path> ignore_files;
+      if (get_config().get_use_gitignore()) ignore_files.push_back(gitignore_file_name);
+      ignore_files.push_back(ignore_file_name);
+      ignore_matcher.set_root(top_level_dir, ignore_files);
+
+      // let the matcher ignore our internal files automatically
+      ignore_matcher.add_internal_pattern(cfg_dir.filename().string() + "/");
+      ignore_matcher.add_internal_pattern(ignore_file_name.filename().string());
+    });
+  }
+
+  const IgnoreTree& Srdp::get_ignore_matcher(){
+    load_ignore_rules();
+    return ignore_matcher;
+  }
+
+  void Srdp::reload_ignore_rules(){
+    load_ignore_rules();
+    ignore_matcher.clear_cache();
+  }
+
+  void Srdp::close_session(){
+    std::lock_guard<std::mutex> lock(sessions_mutex);
+    sessions.erase(std::this_thread::get_id());
+  }
+
+  void Srdp::check_db_schema_version(session_t& s){
+    auto& db = s.db;
+    auto& config = s.config;
+    std::string version = config.get_string("db_schema_version");
+
+    if (version == db_schema_version) return;
+
+    // Upgrade older databases step by step. A failed step is rolled back,
+    // the connection stays usable (it may be pooled, e.g. in dp serve).
+    auto upgrade = [&](const std::string& next, const std::function<void()>& migrate) {
+      db->exec("BEGIN TRANSACTION;");
+
+      try {
+        migrate();
+        config.set_string("db_schema_version", next);
+        db->exec("COMMIT;");
+      } catch (...) {
+        try {
+          db->exec("ROLLBACK;");
+        } catch (...) {
+          // Already rolled back by SQLite
+        }
+        config.invalidate();
+        throw;
+      }
+
+      version = next;
+    };
+
+    if (version == "1")
+      upgrade("2", [&]() { VerifyState::create_table(*db); });
+
+    if (version == "2")
+      upgrade("3", [&]() { Journal::migrate(*db); });
+
+    if (version == "3") {
+      upgrade("4", [&]() {
+          Search::create_table(*db);
+          Search::rebuild(*db);
+        });
+    }
+
+    if (version == "4") {
+      // Indexes for paged lists, the tables exist already
+      upgrade("5", [&]() {
+          Project::create_table(*db);
+          Experiment::create_table(*db);
+          File::create_table(*db);
+        });
+    }
+
+    // Index for loading files by path
+    if (version == "5")
+      upgrade("6", [&]() { File::create_table(*db); });
+
+    if (version != db_schema_version)
       throw std::runtime_error("Incompatible DB version!");
   }
 
   std::string Srdp::get_user_name(){
     uid_t uid = geteuid();
-    struct passwd *pw = getpwuid(uid);
+
+    // getpwuid is not thread-safe
+    struct passwd pwd;
+    struct passwd *pw = nullptr;
+    std::vector<char> buffer(16384);
+    getpwuid_r(uid, &pwd, buffer.data(), buffer.size(), &pw);
     if (pw) {
         return std::string(pw->pw_name);
     } else {
@@ -126,6 +253,25 @@ namespace srdp {
   }
 
   fs::path Srdp::find_top_level_dir(const fs::path& start_path){
+    // Set by the caller, e.g. a script running many commands
+    if (const char* env = std::getenv(top_level_dir_env)) {
+      fs::path dir = fs::path(env).lexically_normal();
+      if (!dir.has_filename()) dir = dir.parent_path();
+      const fs::path start = fs::absolute(start_path).lexically_normal();
+
+      if (dir.is_absolute()
+          && std::mismatch(dir.begin(), dir.end(), start.begin(), start.end()).first == dir.end()
+          && fs::is_directory(dir / cfg_dir)) {
+
+        // A nested project below dir takes precedence
+        bool nested = false;
+        for (fs::path p = start; p != dir && p != p.parent_path() && !nested; p = p.parent_path())
+          nested = fs::is_directory(p / cfg_dir);
+
+        if (!nested) return dir;
+      }
+    }
+
     fs::path currentPath = fs::canonical(start_path);
 
     while (true) {
@@ -135,7 +281,8 @@ namespace srdp {
             return currentPath;
         }
 
-        if (currentPath.has_parent_path()) {
+        // The parent of the root is the root itself
+        if (currentPath.has_parent_path() && currentPath != currentPath.parent_path()) {
             currentPath = currentPath.parent_path();
         } else {
             throw std::runtime_error("Can not find srdp top level directory.");
@@ -144,7 +291,7 @@ namespace srdp {
   }
 
   fs::path Srdp::get_store_dir(){
-    return rel_to_top(top_level_dir / config.get_store_path(), true);
+    return rel_to_top(top_level_dir / get_config().get_store_path(), true);
   }
 
   fs::path Srdp::get_cfg_dir(){
@@ -248,32 +395,95 @@ namespace srdp {
     fs::remove(tmp_name);
   }
 
+  void Srdp::savepoint(const std::string& name){
+    writer.lock();
+
+    try {
+      db()->exec("SAVEPOINT " + name + ";");
+    } catch (...) {
+      writer.unlock();
+      throw;
+    }
+  }
+
+  void Srdp::release(const std::string& name){
+    db()->exec("RELEASE " + name + ";");
+    writer.unlock();
+  }
+
+  void Srdp::rollback(const std::string& name){
+    db()->exec("ROLLBACK TO " + name + "; RELEASE " + name + ";");
+    writer.unlock();
+
+    // Cached objects and config may hold rolled back changes
+    invalidate_cache();
+    get_config().invalidate();
+  }
+
+  void Srdp::invalidate_cache(){
+    auto& s = session();
+    s.project_cache.clear();
+    s.experiment_cache.clear();
+  }
+
+  void Srdp::check_cache(){
+    auto& s = session();
+    const int64_t version = s.config.get_data_version();
+    if (version != s.cache_version) {
+      invalidate_cache();
+      s.cache_version = version;
+    }
+  }
+
   Project Srdp::create_project(const std::string& name){
-    Project prj(db, name, true);
-    config.set_project(prj.uuid);
+    std::lock_guard<std::recursive_mutex> lock(writer);
+    invalidate_cache();
+
+    Project prj(db(), name, true);
+    get_config().set_project(prj.uuid);
 
     return prj;
   }
 
   Project Srdp::open_project(const std::string& name){
+    check_cache();
+
+    auto& s = session();
+
+    // The active project is cached under its uuid
+    const std::string key = name.empty() ? uuids::to_string(s.config.get_project()) : name;
+
+    auto it = s.project_cache.find(key);
+    if (it != s.project_cache.end()) return it->second;
+
     if (name.empty()){
-      return Project(db, config.get_project());
+      return s.project_cache.emplace(key, Project(s.db, s.config.get_project())).first->second;
     } else if (is_uuid(name))
-      return Project(db, uuids::string_generator()(name));
+      return s.project_cache.emplace(key, Project(s.db, uuids::string_generator()(name))).first->second;
     else
-      return Project(db, name, false);
+      return s.project_cache.emplace(key, Project(s.db, name, false)).first->second;
   }
 
   void Srdp::remove_project(const std::string& name){
+    std::lock_guard<std::recursive_mutex> lock(writer);
     Project prj = open_project(name);
+    invalidate_cache();
     prj.remove();
   }
 
+  void Srdp::update_project(Project& prj){
+    std::lock_guard<std::recursive_mutex> lock(writer);
+    invalidate_cache();
+    prj.update();
+  }
+
   Experiment Srdp::create_experiment(const std::string& name, const std::string& project){
+    std::lock_guard<std::recursive_mutex> lock(writer);
     Project prj = open_project(project);
-    Experiment exp(db, prj, name, true);
+    invalidate_cache();
+    Experiment exp(db(), prj, name, true);
 
-    config.set_experiment(exp.uuid);
+    get_config().set_experiment(exp.uuid);
 
     return exp;
   }
@@ -281,58 +491,167 @@ namespace srdp {
   Experiment Srdp::open_experiment(const std::string& name, const std::string& project){
     Project prj = open_project(project);
 
+    auto& s = session();
+
+    const std::string key = uuids::to_string(prj.uuid) + "/"
+      + (name.empty() ? uuids::to_string(s.config.get_experiment()) : name);
+
+    auto it = s.experiment_cache.find(key);
+    if (it != s.experiment_cache.end()) return it->second;
+
     if (name.empty()){
-      return Experiment(db, prj, config.get_experiment());
+      return s.experiment_cache.emplace(key, Experiment(s.db, prj, s.config.get_experiment())).first->second;
     } else if (is_uuid(name)){
-      return Experiment(db, prj, uuids::string_generator()(name));
+      return s.experiment_cache.emplace(key, Experiment(s.db, prj, uuids::string_generator()(name))).first->second;
     } else
-      return Experiment(db, prj, name, false);
+      return s.experiment_cache.emplace(key, Experiment(s.db, prj, name, false)).first->second;
   }
 
   void Srdp::remove_experiment(const std::string& name, const std::string& project){
-    open_experiment(name, project).remove();
+    std::lock_guard<std::recursive_mutex> lock(writer);
+    Experiment exp = open_experiment(name, project);
+    invalidate_cache();
+    exp.remove();
+  }
+
+  void Srdp::update_experiment(Experiment& exp){
+    std::lock_guard<std::recursive_mutex> lock(writer);
+    invalidate_cache();
+    exp.update();
   }
 
   File Srdp::add_file(const std::string& project, const std::string& experiment, const fs::path& name, File::role_t role){
-    Experiment exp = open_experiment(experiment, project);
-    File dbfile(db, exp);
+    return add_file(open_experiment(experiment, project), name, role);
+  }
+
+  File Srdp::add_file(const Experiment& exp, const fs::path& name, File::role_t role){
+    // Create a link that is relative to project dir? FIXME: Distinguish between external/internal store?
+    scas::Store store(get_store_dir());
+    return add_file(exp, name, role, store);
+  }
+
+  std::vector<File> Srdp::add_files(const Experiment& exp, const std::vector<fs::path>& names, File::role_t role,
+      const std::function<void(const fs::path& name, const File& file)>& added){
+    scas::Store store(get_store_dir());
+
+    struct stored_t {
+      fs::path name;
+      std::string hash_str;
+      File file;
+    };
+
+    // Hashing and copying do not hold the writer, a failing file
+    // stops the list, the files before it are still added
+    std::vector<stored_t> stored;
+    stored.reserve(names.size());
+    std::exception_ptr error;
+
+    for (const auto& name : names) {
+      try {
+        std::string hash_str;
+        File file = store_file(exp, name, role, store, hash_str);
+        stored.push_back({name, std::move(hash_str), std::move(file)});
+      } catch (...) {
+        error = std::current_exception();
+        break;
+      }
+    }
+
+    // Only the inserts are in the transaction
+    size_t created = 0;
+    savepoint("add_files");
+
+    for (; created < stored.size(); created++) {
+      try {
+        stored[created].file.create();
+      } catch (...) {
+        error = std::current_exception();
+        break;
+      }
+    }
+
+    try {
+      release("add_files");
+    } catch (...) {
+      rollback("add_files");
+      throw;
+    }
+
+    std::vector<File> files;
+    files.reserve(created);
+
+    for (size_t i=0; i < created; i++) {
+      link_file(stored[i].name, stored[i].hash_str, store);
+      if (added) added(stored[i].name, stored[i].file);
+      files.push_back(std::move(stored[i].file));
+    }
+
+    if (error)
+      std::rethrow_exception(error);
+
+    return files;
+  }
+
+  File Srdp::add_file(const Experiment& exp, const fs::path& name, File::role_t role, scas::Store& store){
+    std::string hash_str;
+    File dbfile = store_file(exp, name, role, store, hash_str);
+
+    // Hashing and copying of other threads can go on meanwhile
+    {
+      std::lock_guard<std::recursive_mutex> lock(writer);
+      dbfile.create();
+    }
+
+    link_file(name, hash_str, store);
+
+    return dbfile;
+  }
+
+  File Srdp::store_file(const Experiment& exp, const fs::path& name, File::role_t role, scas::Store& store, std::string& hash_str){
+    if (!path_is_in_dir(name))
+      throw std::runtime_error("File not in project directory");
+
+    File dbfile(db(), exp);
     dbfile.role = role;
     dbfile.original_name = name.filename();
     dbfile.path = rel_to_top(name, true);
     dbfile.owner = get_user_name();
     dbfile.ctime = get_timestamp_now();  // FIXME use actual file mtime
 
-    if (!path_is_in_dir(name)) // FIXME check for this first before we open the experiment?
-      throw std::runtime_error("File not in project directory");
+    bool exists;
+    {
+      Timings::Span span("store.file_is_in_store");
+      exists = store.file_is_in_store(name);
+    }
 
-    // Create a link that is relative to project dir? FIXME: Distinguish between external/internal store?
-    scas::Store store(get_store_dir());
+    dbfile.size = sys::file_size(name); // FIXME: scas should return that!?
 
-    std::string hash_str;
-    bool exists = store.file_is_in_store(name);
     if (exists) {
       hash_str = store.get_hash_from_path(name);
     } else {
+      Timings::Span span("store.copy_to_store");
       store.copy_to_store(name, hash_str);
+      Timings::add(Timings::counter_t::bytes_hashed, dbfile.size);
+      Timings::add(Timings::counter_t::bytes_copied, dbfile.size);
     }
 
-    scas::Hash::hash_t hash_bin = scas::Hash::convert_string_to_hash(hash_str);
+    dbfile.hash = scas::Hash::convert_string_to_hash(hash_str);
 
-    dbfile.hash = hash_bin;
-    dbfile.size = fs::file_size(name); // FIXME: scas should return that!?
-    dbfile.create();
+    return dbfile;
+  }
 
+  void Srdp::link_file(const fs::path& name, const std::string& hash_str, scas::Store& store){
     fs::remove(name);
 
+    Timings::Span span("store.create_store_link");
     store.create_store_link(name, hash_str);
     store.register_gc_link(name, hash_str);
-
-    return dbfile;
   }
 
   void Srdp::unlink_file(const std::string& project, const std::string& experiment, const std::string& id){
+    std::lock_guard<std::recursive_mutex> lock(writer);
     auto exp = open_experiment(experiment, project);
-    auto file = load_file(project, experiment, id);
+    auto file = load_file(exp, id);
     auto path = file.path;
     auto creator = file.creator_uuid;
 
@@ -360,7 +679,11 @@ namespace srdp {
   }
 
   File Srdp::load_file(const std::string& project, const std::string& experiment, const std::string& id){
-    auto file = get_file(project, experiment);
+    return load_file(open_experiment(experiment, project), id);
+  }
+
+  File Srdp::load_file(const Experiment& exp, const std::string& id){
+    File file(db(), exp);
 
     try {
       file.load(scas::Hash::convert_string_to_hash(id));
@@ -371,103 +694,462 @@ namespace srdp {
     return file;
   }
 
-  void Srdp::verify(){
-    scas::Store store(get_store_dir());
+  // Compare content of store object with its hash
+  static bool object_hash_matches(const fs::path& path, const scas::Hash::hash_t& expected){
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    scas::Hash hash;
+    std::string buffer(1 << 20, '\0');
+
+    while (file) {
+      file.read(buffer.data(), buffer.size());
+      const auto nread = file.gcount();
+      if (nread <= 0) break;
+      if (size_t(nread) < buffer.size()) buffer.resize(nread);
+      hash.update(buffer);
+      Timings::add(Timings::counter_t::bytes_hashed, nread);
+    }
 
-    if (!store.verify_store())
-      std::cout << "Store is inconsistent!" << "\n";
+    return hash.get_hash_binary() == expected;
+  }
 
-    // check if files match DB
-    auto file_list = File(db).get_all_files();
+  // Check a single file mapping. Deep checks re-hash the store object.
+  static VerifyState::result_t check_mapping(const fs::path& top_level_dir, const File& f, scas::Store& store, bool deep){
+    if (!f.path)
+      return VerifyState::result_t::no_path;
+
+    const fs::path path = top_level_dir / *f.path;
+
+    if (!sys::exists(path))
+      return VerifyState::result_t::missing;
 
-    for (auto f : file_list) {
-      if (!f.path) {
+    bool in_store;
+    {
+      Timings::Span span("store.file_is_in_store");
+      in_store = store.file_is_in_store(path) && store.path_coincides_with_store(path);
+    }
+
+    if (!in_store)
+      return VerifyState::result_t::not_in_store;
+    else if (sys::file_size(path) != f.size)
+      return VerifyState::result_t::wrong_size;
+    else if (deep && !object_hash_matches(fs::canonical(path), f.hash))
+      return VerifyState::result_t::corrupt;
+
+    return VerifyState::result_t::ok;
+  }
+
+  static void print_verify_result(const File& f, VerifyState::result_t result){
+    switch (result) {
+      case VerifyState::result_t::ok:
+        break;
+      case VerifyState::result_t::no_path:
         std::cout << "File " << scas::Hash::convert_hash_to_string(f.hash) << " "
           << (f.original_name ? *f.original_name : "")
           << " has no path assigned!\n";
-
-      } else if (!fs::exists(top_level_dir / *f.path)) {
+        break;
+      case VerifyState::result_t::missing:
         std::cout << *f.path << " does not exist!\n";
-      } else if (!store.file_is_in_store(top_level_dir / *f.path) || !store.path_coincides_with_store(top_level_dir / *f.path)) {
+        break;
+      case VerifyState::result_t::not_in_store:
         std::cout << *f.path << " is not located in store!\n";
-      } else if (fs::file_size(top_level_dir / *f.path) != f.size) {
+        break;
+      case VerifyState::result_t::wrong_size:
         std::cout << *f.path << " has the wrong file size in DB!\n";
+        break;
+      case VerifyState::result_t::corrupt:
+        std::cout << *f.path << " does not match its hash!\n";
+        break;
+    }
+  }
+
+  void Srdp::verify(const VerifyOptions& opts){
+    if (opts.sample_fraction > 0 || opts.sample_count > 0) {
+      verify_sample(opts);
+      return;
+    }
+
+    scas::Store store(get_store_dir());
+
+    // A full store check touches every object. Skip it in incremental mode.
+    if (!opts.incremental && !store.verify_store())
+      std::cout << "Store is inconsistent!" << "\n";
+
+    VerifyState state(db());
+    auto last_state = state.load_all();
+
+    // check if files match DB
+    auto file_list = File(db()).get_all_files();
+    const ctime_t now = get_timestamp_now();
+    size_t checked = 0;
+
+    std::lock_guard<std::recursive_mutex> lock(writer);
+    db()->exec("BEGIN TRANSACTION;");
+
+    try {
+      for (auto f : file_list) {
+        VerifyState::entry_t entry;
+        entry.verified = now;
+
+        std::optional<VerifyState::fingerprint_t> fp;
+        if (f.path)
+          fp = VerifyState::fingerprint(top_level_dir / *f.path);
+
+        if (fp)
+          entry.fingerprint = *fp;
+
+        // Skip unchanged mappings that passed their last check
+        if (opts.incremental && fp) {
+          auto it = last_state.find(VerifyState::key_t(f.experiment, f.hash));
+          if (it != last_state.end()
+              && it->second.result == VerifyState::result_t::ok
+              && it->second.fingerprint == *fp
+              && (opts.max_age < 0 || now - it->second.verified < opts.max_age))
+            continue;
+        }
+
+        checked++;
+
+        entry.result = check_mapping(top_level_dir, f, store, false);
+        print_verify_result(f, entry.result);
+
+        state.record(f.experiment, f.hash, entry);
+      }
+
+      db()->exec("COMMIT;");
+    } catch (...) {
+      db()->exec("ROLLBACK;");
+      throw;
+    }
+
+    if (opts.incremental)
+      std::cout << "Checked " << checked << " of " << file_list.size() << " file mappings\n";
+  }
+
+  void Srdp::verify_sample(const VerifyOptions& opts){
+    auto file_list = File(db()).get_all_files();
+
+    if (file_list.empty()) {
+      std::cout << "No files mapped\n";
+      return;
+    }
+
+    // Pick a size weighted sample
+    size_t count = opts.sample_count;
+    if (opts.sample_fraction > 0)
+      count = std::ceil(opts.sample_fraction * file_list.size());
+
+    count = std::min(count, file_list.size());
+
+    std::vector<size_t> weights(file_list.size());
+    std::transform(file_list.cbegin(), file_list.cend(), weights.begin(), [](const File& f) { return f.size; });
+
+    const uint64_t seed = opts.sample_seed ? *opts.sample_seed : std::random_device()();
+    const auto selected = sample_weighted(weights, count, seed);
+
+    // Deep check the sample in parallel
+    std::vector<VerifyState::result_t> results(selected.size(), VerifyState::result_t::ok);
+    std::atomic<size_t> next(0);
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    // Read from the config once, workers must not use the DB
+    const fs::path store_dir = get_store_dir();
+
+    auto worker = [&]() {
+      try {
+        scas::Store store(store_dir);
+
+        for (size_t i = next++; i < selected.size(); i = next++)
+          results[i] = check_mapping(top_level_dir, file_list[selected[i]], store, true);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+      }
+    };
+
+    unsigned njobs = opts.jobs > 0 ? opts.jobs : std::max(1u, std::thread::hardware_concurrency());
+    njobs = std::min<size_t>(njobs, selected.size());
+
+    std::vector<std::thread> threads;
+    for (unsigned i=0; i < njobs; i++)
+      threads.emplace_back(worker);
+
+    for (auto& t : threads)
+      t.join();
+
+    if (error)
+      std::rethrow_exception(error);
+
+    // Report
+    size_t failures = 0;
+    size_t bytes = 0;
+    for (size_t i=0; i < selected.size(); i++) {
+      const File& f = file_list[selected[i]];
+      bytes += f.size;
+      if (results[i] != VerifyState::result_t::ok) {
+        failures++;
+        print_verify_result(f, results[i]);
+      }
+    }
+
+    std::cout << "Checked " << selected.size() << " of " << file_list.size()
+      << " file mappings (" << bytes << " bytes, seed " << seed << ")\n";
+    std::cout << "Failed: " << failures << "\n";
+    std::cout << "Corruption rate (size weighted): <= "
+      << 100.0 * wilson_upper_bound(failures, selected.size()) << "% (95% confidence)\n";
+  }
+
+  uint64_t Srdp::get_index_stamp(){
+    // FNV-1a over everything the classification depends on
+    uint64_t stamp = 14695981039346656037ull;
+    auto update = [&stamp](const std::string& str) {
+      for (char c : str + "\n") {
+        stamp ^= static_cast<unsigned char>(c);
+        stamp *= 1099511628211ull;
       }
+    };
+
+    update(fs::absolute(top_level_dir / get_config().get_store_path()).lexically_normal());
+    update(std::to_string(get_ignore_matcher().get_fingerprint()));
+
+    return stamp;
+  }
+
+  static int64_t timespec_to_ns(const struct timespec& ts){
+    return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+  }
+
+  std::unordered_set<std::string> Srdp::get_active_paths(){
+    std::unordered_set<std::string> active_paths;
+    if (!get_config().get_experiment().is_nil()) {
+      for (auto& path : get_file().list_paths())
+        active_paths.insert(std::move(path));
     }
+    return active_paths;
   }
 
-  // helper function for get file list
-  void iterate_dir(const fs::path& dir,
-                  std::list<Srdp::DirEntry>& list_untracked,
-                  std::list<Srdp::DirEntry>& list_tracked,
-                  scas::Store& store,
-                  Srdp& srdp
-                  ) {
+  std::vector<fs::path> Srdp::classify_dir(int dirfd, const fs::path& dir, const struct stat& dir_stat,
+      const std::vector<DirWalker::Entry>& entries, scas::Store& store,
+      const std::unordered_set<std::string>& active_paths,
+      std::list<DirEntry>& list_untracked, std::list<DirEntry>& list_tracked, WorkspaceIndex::dir_t& record){
+
+    std::vector<fs::path> subdirs;
+
+    // Directories modified within this window may change again
+    // without a visible mtime change and are not reused.
+    const int64_t racy_limit = (int64_t(get_timestamp_now()) - 2) * 1000000000;
+
+    record.mtime = timespec_to_ns(dir_stat.st_mtim);
+    record.ino = dir_stat.st_ino;
+    const std::string rel_dir = dir.lexically_relative(top_level_dir).string();
+    record.rules = get_ignore_matcher().get_rules(rel_dir)->fingerprint;
+    record.entries.clear();
+
+    if (record.mtime >= racy_limit) record.mtime = 0;
+
+    auto add_record = [&](WorkspaceIndex::kind_t kind, const fs::path& path, fs::file_time_type mtime) {
+      record.entries.push_back(WorkspaceIndex::entry_t{kind, mtime.time_since_epoch().count(),
+          path.lexically_relative(top_level_dir).string()});
+    };
+
+    // Resolve entry types, the file system may not provide them
+    std::vector<unsigned char> types(entries.size());
+    std::vector<IgnoreTree::entry_t> candidates;
+    std::vector<size_t> candidate_index;
+
+    for (size_t i=0; i < entries.size(); i++) {
+      unsigned char type = entries[i].type;
+
+      if (type == DT_UNKNOWN) {
+        struct stat st;
+        if (sys::fstatat(dirfd, entries[i].name.c_str(), &st, AT_SYMLINK_NOFOLLOW) != 0) continue;
+        if (S_ISLNK(st.st_mode)) type = DT_LNK;
+        else if (S_ISREG(st.st_mode)) type = DT_REG;
+        else if (S_ISDIR(st.st_mode)) type = DT_DIR;
+      }
+
+      types[i] = type;
+      if (type == DT_REG || type == DT_DIR) {
+        candidates.push_back(IgnoreTree::entry_t{entries[i].name, type == DT_DIR});
+        candidate_index.push_back(i);
+      }
+    }
+
+    // Check all files and directories against the ignore rules at once
+    std::vector<bool> ignored(entries.size(), false);
+    const auto ignored_candidates = get_ignore_matcher().is_ignored(rel_dir, candidates);
+    for (size_t i=0; i < candidates.size(); i++)
+      ignored[candidate_index[i]] = ignored_candidates[i];
 
-    Experiment exp = srdp.open_experiment();
+    for (size_t i=0; i < entries.size(); i++) {
+      const fs::path path = dir / entries[i].name;
+      const unsigned char type = types[i];
+
+      if (ignored[i]) continue;
 
-    for (const auto& entry : fs::directory_iterator(dir)) {
       // Resolve symlinks
-      if (fs::is_symlink(symlink_status(entry.path()))) {
+      if (type == DT_LNK) {
 
         // Symlink is in store?
-        if (store.file_is_in_store(entry.path())) {
-          // check if file belongs to active experiment
+        bool in_store;
+        {
+          Timings::Span span("store.file_is_in_store");
+          in_store = store.file_is_in_store(path);
+        }
 
-          bool is_active = false;
-          auto flist = srdp.get_file().list();
-          for (auto file: flist) {
-            std::cout << srdp.rel_to_top(entry.path(), true).string() << ":" << *file.path << std::endl;
-            if (srdp.rel_to_top(entry.path(), true).string() == *file.path) is_active = true;
-          }
+        if (in_store) {
+          // check if file belongs to active experiment
+          bool is_active = active_paths.count(rel_to_top(path, true).string()) > 0;
 
-          list_tracked.push_back(Srdp::DirEntry{entry.path(), fs::last_write_time(entry.path()), true, is_active});
+          list_tracked.push_back(DirEntry{path, sys::last_write_time(path), true, is_active});
+          add_record(WorkspaceIndex::kind_t::tracked, path, list_tracked.back().mtime);
         } else {
+          // Targets of foreign symlinks can change without touching the directory
+          record.mtime = 0;
+
           // follow symlink
           std::error_code ec;
-          fs::path target = fs::canonical(entry.path(), ec);
-          if (!ec) {
+          fs::path target = sys::canonical(path, ec);
+          if (!ec && path_is_in_dir(target)) {
+            const auto target_status = sys::status(target, ec);
             // regular file
-            if (srdp.path_is_in_dir(target) && fs::is_regular_file(target)) {
-              list_untracked.push_back(Srdp::DirEntry{target, fs::last_write_time(entry.path()), false, false});
+            if (fs::is_regular_file(target_status)) {
+              list_untracked.push_back(DirEntry{target, sys::last_write_time(path), false, false});
             }
             // directory
-            if (srdp.path_is_in_dir(target) && fs::is_directory(target)) {
-              iterate_dir(target, list_untracked, list_tracked, store, srdp);
+            if (fs::is_directory(target_status)) {
+              subdirs.push_back(target);
             }
           }
         }
       // Regular file
-      } else if (fs::is_regular_file(entry.status())) {
-        // Check if file should be ignored
-        if (srdp.get_ignore_matcher().is_ignored(entry.path())) continue;
-
-        list_untracked.push_back(Srdp::DirEntry{entry.path(), fs::last_write_time(entry.path()), false, false});
+      } else if (type == DT_REG) {
+        list_untracked.push_back(DirEntry{path, sys::last_write_time(path), false, false});
+        add_record(WorkspaceIndex::kind_t::untracked, path, list_untracked.back().mtime);
 
       // recurse into subdirectories
-      } else if (fs::is_directory(entry.status())) {
-        // Skip internal directories
-        //if (srdp.rel_to_top(entry.path()) == Srdp::cfg_dir) continue;
-        if (srdp.get_ignore_matcher().is_ignored(entry.path())) continue;
-        iterate_dir(entry.path(), list_untracked, list_tracked, store, srdp);
+      } else if (type == DT_DIR) {
+        subdirs.push_back(path);
+        add_record(WorkspaceIndex::kind_t::subdir, path, fs::file_time_type());
       }
     }
+
+    return subdirs;
   }
 
-  std::list<Srdp::DirEntry> Srdp::get_file_list(bool only_active){
+  std::list<Srdp::DirEntry> Srdp::get_file_list(bool only_active, unsigned threads, bool use_index){
 
-    std::list<DirEntry> list_untracked;
-    std::list<DirEntry> list_tracked;
+    DirWalker walker(threads);
 
-    scas::Store store(get_store_dir());
+    // Results are collected per worker thread and merged at the end
+    std::vector<std::list<DirEntry>> lists_untracked(walker.get_threads());
+    std::vector<std::list<DirEntry>> lists_tracked(walker.get_threads());
+    std::vector<std::unique_ptr<scas::Store>> stores;
+    for (unsigned i=0; i < walker.get_threads(); i++)
+      stores.push_back(std::make_unique<scas::Store>(get_store_dir()));
+
+    // Paths of the active experiment, loaded once for the whole walk
+    const std::unordered_set<std::string> active_paths = get_active_paths();
+
+    // Workspace index: unchanged directories are taken from the cache
+    const fs::path index_path = get_cfg_dir() / index_file_name;
+    const uint64_t index_stamp = get_index_stamp();
+    std::unique_ptr<WorkspaceIndex> index;
+    if (use_index)
+      index = std::make_unique<WorkspaceIndex>(index_path, index_stamp);
+
+    std::vector<std::map<std::string, WorkspaceIndex::dir_t>> index_records(walker.get_threads());
+    std::atomic<bool> index_dirty(false);
+
+    auto index_key = [this](const fs::path& dir) {
+      return dir.lexically_relative(top_level_dir).string();
+    };
+
+    auto prefilter = [&](unsigned worker, const fs::path& dir, std::vector<fs::path>& subdirs) {
+      struct stat st;
+      if (sys::stat(dir.c_str(), &st) != 0) return false;
+
+      const std::string key = index_key(dir);
+      const uint64_t rules = get_ignore_matcher().get_rules(key)->fingerprint;
+      WorkspaceIndex::dir_t record;
+      if (!index->lookup(key, timespec_to_ns(st.st_mtim), st.st_ino, rules, record)) {
+        index_dirty = true;
+        return false;
+      }
+
+      for (const auto& e : record.entries) {
+        const fs::path path = top_level_dir / e.path;
+        const fs::file_time_type mtime{fs::file_time_type::duration(e.mtime)};
+
+        switch (e.kind) {
+          case WorkspaceIndex::kind_t::untracked:
+            lists_untracked[worker].push_back(DirEntry{path, mtime, false, false});
+            break;
+          case WorkspaceIndex::kind_t::tracked:
+            lists_tracked[worker].push_back(DirEntry{path, mtime, true, active_paths.count(e.path) > 0});
+            break;
+          case WorkspaceIndex::kind_t::subdir:
+            subdirs.push_back(path);
+            break;
+        }
+      }
+
+      index_records[worker][key] = std::move(record);
+      return true;
+    };
+
+    auto classify = [&](unsigned worker, int dirfd, const fs::path& dir, const struct stat& dir_stat, std::vector<DirWalker::Entry>& entries) {
+      WorkspaceIndex::dir_t record;
+      auto subdirs = classify_dir(dirfd, dir, dir_stat, entries, *stores[worker], active_paths,
+          lists_untracked[worker], lists_tracked[worker], record);
+
+      if (use_index)
+        index_records[worker][index_key(dir)] = std::move(record);
+
+      return subdirs;
+    };
 
     try {
       // Iterate over the file list
-      iterate_dir(top_level_dir, list_untracked, list_tracked, store, *this);
+      if (use_index)
+        walker.walk(top_level_dir, classify, prefilter);
+      else
+        walker.walk(top_level_dir, classify);
     } catch (const fs::filesystem_error& e) {
         std::cerr << "Filesystem error: " << e.what() << "\n";
+        index_dirty = false;
+        use_index = false;
+    }
+
+    // Write back index if anything changed
+    if (use_index) {
+      std::map<std::string, WorkspaceIndex::dir_t> records;
+      for (auto& r : index_records)
+        records.merge(r);
+
+      if (index_dirty || records.size() != index->size()) {
+        try {
+          WorkspaceIndex::write(index_path, index_stamp, records);
+        } catch (const fs::filesystem_error& e) {
+          // Index is only a cache, e.g. workspace may be read-only
+        }
+      }
+    }
+
+    std::list<DirEntry> list_untracked;
+    std::list<DirEntry> list_tracked;
+
+    for (unsigned i=0; i < walker.get_threads(); i++) {
+      list_untracked.splice(list_untracked.end(), lists_untracked[i]);
+      list_tracked.splice(list_tracked.end(), lists_tracked[i]);
     }
 
+    return merge_file_list(list_untracked, list_tracked);
+  }
+
+  std::list<Srdp::DirEntry> Srdp::merge_file_list(std::list<DirEntry>& list_untracked, std::list<DirEntry>& list_tracked){
     list_untracked.sort();
     list_untracked.unique();
 
@@ -476,13 +1158,6 @@ namespace srdp {
 
     list_untracked.splice(list_untracked.end(), list_tracked);
 
-    // look for .srdpignore
-    // look for .gitignore
-    // check: is in store
-    // check: is active experiment?
-    // check: what is the file's role?
-
-    return list_untracked;
+    return std::move(list_untracked);
   }
 }
-
@@ -8,14 +8,24 @@
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/uuid/string_generator.hpp>
+#include <atomic>
 #include <regex>
 #include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
 
 #include "project.h"
 #include "experiment.h"
+#include "journal.h"
 #include "files.h"
 #include "ignore_file.h"
 #include "config.h"
+#include "verify.h"
+#include "search.h"
+#include "report.h"
+#include "dir_walker.h"
+#include "workspace_index.h"
 
 #include "cmake_config.h"
 
@@ -42,48 +52,111 @@ namespace srdp {
     private:
       const fs::path gc_roots_dir = "gc-roots"; // Needed as seperate dir?
 
-      std::shared_ptr<Sql> db;
-      IgnoreFile ignore_matcher;
+      // DB connection of a thread and the state read through it
+      struct session_t {
+        std::shared_ptr<Sql> db;
+        Config config;
+
+        // Resolved projects and experiments, keyed by the name/uuid they were opened with
+        std::unordered_map<std::string, Project> project_cache;
+        std::unordered_map<std::string, Experiment> experiment_cache;
+        int64_t cache_version = -1; // DB data version the caches belong to
+      };
+
+      // Connection pool, one session per thread
+      std::mutex sessions_mutex;
+      std::unordered_map<std::thread::id, std::unique_ptr<session_t>> sessions;
+
+      // Held by the thread that is writing, from savepoint to release/rollback
+      std::recursive_mutex writer;
+
+      // Set up on first use, short commands do not need everything.
+      // A failed DB check is repeated, which call_once does not do
+      // reliably for a throwing function (e.g. with TSan).
+      std::mutex db_check_mutex;
+      std::atomic<bool> db_checked{false};
+      std::once_flag ignore_loaded;
+
+      IgnoreTree ignore_matcher;
       bool interactive = false;
       fs::path top_level_dir;
 
-      void init_();
+      void init_(const fs::path& start);
+      session_t& session();
+      std::shared_ptr<Sql>& db() { return session().db; }
+      void load_ignore_rules();
+      void check_cache();
+      File add_file(const Experiment& exp, const fs::path& name, File::role_t role, scas::Store& store);
+      // Hash and copy to the store, the entry is not created yet
+      File store_file(const Experiment& exp, const fs::path& name, File::role_t role, scas::Store& store, std::string& hash_str);
+      // Replace the file by a link to the store
+      void link_file(const fs::path& name, const std::string& hash_str, scas::Store& store);
       void find_last_experiment();
       void find_open_experiments();
 
-      void check_db_schema_version();
+      void check_db_schema_version(session_t& s);
+      void verify_sample(const VerifyOptions& opts);
     public:
       static const std::string db_schema_version;
       static const fs::path cfg_dir;
       static const fs::path db_file;
       static const fs::path ignore_file_name;
+      static const fs::path gitignore_file_name;
       static const fs::path default_store_dir;
+      static const fs::path index_file_name;
+      static const char* top_level_dir_env;
 
-      Config config;
-
-      // Try to find the config automatically
+      /* Try to find the config automatically.
+       *
+       * Only the top level directory is looked up here. The DB is opened
+       * and checked, and the ignore rules are read, on first use.
+       *
+       * The API can be used from several threads. Every thread gets its
+       * own DB connection, reads run concurrently, and writes through Srdp
+       * are serialized. Objects returned (Project, File, ...) use the
+       * connection of the thread that created them and must stay in it.
+       */
       Srdp();
 
       // Open by project path
       Srdp(const fs::path& project_path, bool interactive = false);
 
+      Srdp(const Srdp&) = delete;
+      Srdp& operator=(const Srdp&) = delete;
+
+      // Settings as seen by the calling thread
+      Config& get_config() { return session().config; }
+
+      // Close the DB connection of the calling thread, e.g. before it exits
+      void close_session();
+
       /* Create new directory.
        *
        * Directory must not exist.
        * If path is given the CAS is assumend to be external (and existing).
        */
-      static void init(const fs::path& dir, const fs::path& store = fs::path());
+      static void init(const fs::path& dir, const fs::path& store = fs::path(), bool use_gitignore = false);
 
       // Check if path is project's directory
       bool path_is_in_dir(const fs::path& path);
 
-      fs::path find_top_level_dir(const fs::path& start_path);
+      /* Find the directory containing the config dir, starting at start_path.
+       *
+       * If the environment variable SRDP_TOP_LEVEL_DIR names a project
+       * directory that contains start_path, and no other project lies
+       * in between, the search is skipped.
+       * The variable must hold a canonical path.
+       */
+      static fs::path find_top_level_dir(const fs::path& start_path);
       fs::path get_store_dir();
       fs::path get_cfg_dir();
       fs::path rel_to_top(const fs::path& path, bool proximate = false);
 
       const fs::path& get_top_level_dir() { return top_level_dir; }
-      const IgnoreFile& get_ignore_matcher() { return ignore_matcher; }
+      const IgnoreTree& get_ignore_matcher();
+
+      // Re-read ignore files on next use
+      void reload_ignore_rules();
 
       static std::string get_time_stamp_fmt(ctime_t = get_timestamp_now());
       static std::string get_user_name();
@@ -91,30 +164,99 @@ namespace srdp {
 
       void edit_text(std::string& text);
 
+      /* Projects and experiments are resolved once per name/uuid.
+       *
+       * The cache is dropped on create, remove, and update through Srdp,
+       * and when another connection has modified the DB. Changes made
+       * directly through Project/Experiment objects need invalidate_cache().
+       * Each thread has its own cache.
+       */
+      void invalidate_cache();
+
+      /* Nested transactions (SQLite savepoints).
+       *
+       * Every savepoint ends with release or rollback, releasing the
+       * outermost one commits. Changes made in between nest, e.g. add_files.
+       * Other threads can not write until the outermost one has ended.
+       */
+      void savepoint(const std::string& name);
+      void release(const std::string& name);
+      void rollback(const std::string& name);
+
       Project create_project(const std::string& name);
-      Project get_project() { return Project(db); };
+      Project get_project() { return Project(db()); };
 
       // Takes a name or uuid
       Project open_project(const std::string& name = std::string());
       void remove_project(const std::string& name);
+      void update_project(Project& prj);
 
       void list_experiments();
       Experiment create_experiment(const std::string& name, const std::string& project = std::string());
 
-      Experiment get_experiment(const std::string& project = std::string()) { return Experiment(db, open_project(project)); } ;
+      Experiment get_experiment(const std::string& project = std::string()) { return Experiment(db(), open_project(project)); } ;
       Experiment open_experiment(const std::string& name = std::string(), const std::string& project = std::string());
       void remove_experiment(const std::string& name = std::string(), const std::string& project = std::string());
+      void update_experiment(Experiment& exp);
 
-      File get_file(const std::string& project = std::string(), const std::string& experiment = std::string()) { return File(db, open_experiment(experiment, project)); }
+      Search get_search() { return Search(db()); }
+      Report get_report() { return Report(db()); }
+
+      File get_file(const std::string& project = std::string(), const std::string& experiment = std::string()) { return File(db(), open_experiment(experiment, project)); }
       void list_files();
       File add_file(const std::string& project, const std::string& experiment, const fs::path& name, File::role_t role);
+      File add_file(const Experiment& exp, const fs::path& name, File::role_t role);
+
+      /* Add many files to an open experiment in one transaction.
+       *
+       * The files are hashed and copied to the store before the
+       * transaction, which only holds the inserts. added is called for
+       * each file once it is linked to the store. If a file fails, the
+       * files before it are still added.
+       */
+      std::vector<File> add_files(const Experiment& exp, const std::vector<fs::path>& names, File::role_t role,
+          const std::function<void(const fs::path& name, const File& file)>& added = nullptr);
+
       File load_file(const std::string& project, const std::string& experiment, const std::string& id);
+      File load_file(const Experiment& exp, const std::string& id);
       void unlink_file(const std::string& project, const std::string& experiment, const std::string& id);
 
-      void verify();
+      /* Check consistency of the mapped files with DB and store.
+       *
+       * In incremental mode only mappings that are new, changed, failed,
+       * or older than max_age are checked.
+       * In sampling mode a size weighted random subset of mappings is
+       * deep checked (including content hash) in parallel.
+       */
+      void verify(const VerifyOptions& opts = VerifyOptions());
+
+      /* List files in directory.
+       *
+       * The tree is walked in parallel with threads threads
+       * (0 = number of hardware threads). With use_index, directories
+       * unchanged since the last scan are taken from the workspace index.
+       */
+      std::list<DirEntry> get_file_list(bool only_active = true, unsigned threads = 0, bool use_index = true);
+
+      // Hash over the settings the directory classification depends on
+      uint64_t get_index_stamp();
+
+      // Paths (relative to top level directory) mapped to the active experiment
+      std::unordered_set<std::string> get_active_paths();
+
+      /* Classify the entries of one directory read by the DirWalker.
+       *
+       * Files are appended to untracked and tracked, record receives
+       * the workspace index record of the directory.
+       * Returns the subdirectories to descend into.
+       */
+      std::vector<fs::path> classify_dir(int dirfd, const fs::path& dir, const struct stat& dir_stat,
+          const std::vector<DirWalker::Entry>& entries, scas::Store& store,
+          const std::unordered_set<std::string>& active_paths,
+          std::list<DirEntry>& untracked, std::list<DirEntry>& tracked, WorkspaceIndex::dir_t& record);
 
-      // List files in directory
-      std::list<DirEntry> get_file_list(bool only_active = true);
+      // Sort, remove duplicates, and join untracked and tracked entries
+      static std::list<DirEntry> merge_file_list(std::list<DirEntry>& untracked, std::list<DirEntry>& tracked);
   };
 }
 
@@ -4,6 +4,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <thread>
 #include <catch2/catch_test_macros.hpp>
 
 #include "srdp.h"
@@ -128,6 +129,97 @@ SCENARIO("SRDP management", "[srdp]") {
         REQUIRE_NOTHROW( dp.unlink_file(project_name, experiment_name + "2", f2o) );
         REQUIRE_FALSE( store.file_is_in_store(f2o) );
       }
+
+      THEN("Can add files in bulk") {
+        auto exp = dp.create_experiment(experiment_name);
+
+        std::vector<fs::path> names;
+        for (int i=0; i < 10; i++) {
+          names.push_back(file_name + "b" + std::to_string(i));
+          helper_create_file(names.back(), names.back().string());
+        }
+
+        std::vector<srdp::File> files;
+        REQUIRE_NOTHROW( files = dp.add_files(exp, names, srdp::File::role_t::input) );
+        REQUIRE( files.size() == names.size() );
+        REQUIRE( dp.get_file().list().size() == names.size() );
+
+        // Files before a failing one are kept
+        helper_create_file("last", "last");
+        std::vector<fs::path> reported;
+        REQUIRE_THROWS( dp.add_files(exp, {"last", "../outside"}, srdp::File::role_t::input,
+              [&reported](const fs::path& name, const srdp::File&) { reported.push_back(name); }) );
+        REQUIRE( dp.get_file().list().size() == names.size() + 1 );
+        REQUIRE( reported == std::vector<fs::path>{"last"} );
+        REQUIRE( fs::is_symlink("last") );
+      }
+
+      THEN("Resolution cache follows changes") {
+        auto exp = dp.create_experiment(experiment_name);
+        REQUIRE( dp.open_experiment(experiment_name).uuid == exp.uuid );
+
+        exp.name = experiment_name + "_renamed";
+        REQUIRE_NOTHROW( dp.update_experiment(exp) );
+        REQUIRE_THROWS( dp.open_experiment(experiment_name) );
+        REQUIRE( dp.open_experiment(experiment_name + "_renamed").uuid == exp.uuid );
+
+        REQUIRE_NOTHROW( dp.remove_experiment(experiment_name + "_renamed") );
+        REQUIRE_THROWS( dp.open_experiment(experiment_name + "_renamed") );
+
+        // Changes by another connection
+        auto prj = dp.open_project(project_name);
+        REQUIRE( dp.get_project().list().size() == 1 ); // finishes the open statement
+        {
+          srdp::Srdp dp2;
+          auto prj2 = dp2.open_project(project_name);
+          prj2.name = project_name + "_renamed";
+          dp2.update_project(prj2);
+        }
+        REQUIRE_THROWS( dp.open_project(project_name) );
+        REQUIRE( dp.open_project(project_name + "_renamed").uuid == prj.uuid );
+      }
+
+      THEN("Can be used from several threads") {
+        const int nthreads = 8;
+        const int nexperiments = 10;
+
+        // Assertions are not thread-safe, errors are checked afterwards
+        std::vector<std::string> errors(nthreads);
+        std::vector<size_t> seen(nthreads, 0);
+        std::vector<std::thread> threads;
+
+        for (int t=0; t < nthreads; t++) {
+          threads.emplace_back([&, t]() {
+            try {
+              for (int i=0; i < nexperiments; i++) {
+                const std::string name = "e" + std::to_string(t) + "_" + std::to_string(i);
+                dp.create_experiment(name, project_name);
+
+                if (dp.open_experiment(name, project_name).name != name)
+                  throw std::runtime_error("Wrong experiment " + name);
+
+                seen[t] = dp.get_experiment(project_name).list().size();
+              }
+
+              dp.close_session();
+            } catch (std::exception& e) {
+              errors[t] = e.what();
+            }
+          });
+        }
+
+        for (auto& t : threads)
+          t.join();
+
+        for (int t=0; t < nthreads; t++) {
+          REQUIRE( errors[t] == "" );
+          REQUIRE( seen[t] >= nexperiments );
+        }
+
+        // Writes of the other threads are visible
+        REQUIRE( dp.get_experiment(project_name).list().size() == nthreads * nexperiments );
+        REQUIRE( dp.open_experiment("e3_7", project_name).name == "e3_7" );
+      }
     }
 
     fs::current_path(old_cwd);
@@ -135,6 +227,97 @@ SCENARIO("SRDP management", "[srdp]") {
   }
 }
 
+TEST_CASE("Lazy startup", "[srdp]") {
+  const fs::path dir = fs::absolute("test_srdp_lazy");
+  auto old_cwd = fs::current_path();
+
+  fs::remove_all(dir);
+  fs::create_directories(dir / "sub/deep");
+  fs::current_path(dir);
+  REQUIRE_NOTHROW( srdp::Srdp::init("./") );
+  const fs::path top = fs::current_path();
+
+  fs::current_path(dir / "sub/deep");
+
+  // The DB is checked on first use
+  {
+    srdp::Srdp dp;
+    REQUIRE( dp.get_top_level_dir() == top );
+    fs::rename(top / srdp::Srdp::cfg_dir / srdp::Srdp::db_file, top / "moved.db");
+    fs::create_directory(top / srdp::Srdp::cfg_dir / srdp::Srdp::db_file);
+    REQUIRE_THROWS( dp.open_project() );
+    fs::remove(top / srdp::Srdp::cfg_dir / srdp::Srdp::db_file);
+    fs::rename(top / "moved.db", top / srdp::Srdp::cfg_dir / srdp::Srdp::db_file);
+  }
+
+  // Top level directory from the environment
+  setenv(srdp::Srdp::top_level_dir_env, (top.string() + "/").c_str(), 1);
+  REQUIRE( srdp::Srdp::find_top_level_dir(".") == top );
+
+  // Ignored if it does not contain the start directory or is no project
+  REQUIRE_THROWS( srdp::Srdp::find_top_level_dir("/") );
+  setenv(srdp::Srdp::top_level_dir_env, (top / "sub").c_str(), 1);
+  REQUIRE( srdp::Srdp::find_top_level_dir(".") == top );
+
+  // Not for a nested project in between
+  setenv(srdp::Srdp::top_level_dir_env, top.c_str(), 1);
+  fs::create_directory(top / "sub" / srdp::Srdp::cfg_dir);
+  REQUIRE( srdp::Srdp::find_top_level_dir(".") == top / "sub" );
+  fs::remove(top / "sub" / srdp::Srdp::cfg_dir);
+  REQUIRE( srdp::Srdp::find_top_level_dir(".") == top );
+  unsetenv(srdp::Srdp::top_level_dir_env);
+
+  // Opened by the project path, not the working directory (dp -d)
+  fs::current_path(old_cwd);
+  REQUIRE( srdp::Srdp(dir / "sub").get_top_level_dir() == top );
+  fs::current_path(dir / "sub/deep");
+
+  {
+    srdp::Srdp dp;
+    REQUIRE_NOTHROW( dp.create_project("project") );
+    REQUIRE( dp.get_ignore_matcher().is_ignored(std::string_view(".srdp"), true) );
+  }
+
+  fs::current_path(old_cwd);
+  REQUIRE_NOTHROW( fs::remove_all(dir) );
+}
+
+TEST_CASE("Failed migration", "[srdp]") {
+  const fs::path dir = fs::absolute("test_srdp_migration");
+  auto old_cwd = fs::current_path();
+
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  fs::current_path(dir);
+  REQUIRE_NOTHROW( srdp::Srdp::init("./") );
+
+  const fs::path db_path = dir / srdp::Srdp::cfg_dir / srdp::Srdp::db_file;
+  auto set_version = [&db_path](const std::string& version) {
+    auto db = std::make_shared<srdp::Sql>(db_path);
+    srdp::Config(db).set_string("db_schema_version", version);
+  };
+
+  // The journal columns of version 2 are gone, the step fails
+  set_version("2");
+
+  {
+    srdp::Srdp dp;
+    REQUIRE_THROWS( dp.open_project() );
+
+    // The connection is not left in the failed transaction
+    set_version(srdp::Srdp::db_schema_version);
+    REQUIRE_NOTHROW( dp.create_project("project") );
+  }
+
+  {
+    srdp::Srdp dp;
+    REQUIRE( dp.open_project("project").name == "project" );
+  }
+
+  fs::current_path(old_cwd);
+  REQUIRE_NOTHROW( fs::remove_all(dir) );
+}
+
 // project:
 // - create
 // - load by UUID/name/config
@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <atomic>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "sys_calls.h"
+
+namespace srdp::sys {
+
+  static std::atomic<uint64_t> count_stat(0);
+  static std::atomic<uint64_t> count_open(0);
+  static std::atomic<uint64_t> count_readdir(0);
+
+  static void count(std::atomic<uint64_t>& counter){
+    counter.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  counts_t counts_t::operator-(const counts_t& other) const {
+    counts_t diff;
+    diff.stat = stat - other.stat;
+    diff.open = open - other.open;
+    diff.readdir = readdir - other.readdir;
+    return diff;
+  }
+
+  counts_t get_counts(){
+    counts_t counts;
+    counts.stat = count_stat.load(std::memory_order_relaxed);
+    counts.open = count_open.load(std::memory_order_relaxed);
+    counts.readdir = count_readdir.load(std::memory_order_relaxed);
+    return counts;
+  }
+
+  int stat(const char* path, struct stat* st){
+    count(count_stat);
+    return ::stat(path, st);
+  }
+
+  int lstat(const char* path, struct stat* st){
+    count(count_stat);
+    return ::lstat(path, st);
+  }
+
+  int fstat(int fd, struct stat* st){
+    count(count_stat);
+    return ::fstat(fd, st);
+  }
+
+  int fstatat(int dirfd, const char* path, struct stat* st, int flags){
+    count(count_stat);
+    return ::fstatat(dirfd, path, st, flags);
+  }
+
+  int open(const char* path, int flags, mode_t mode){
+    count(count_open);
+    return ::open(path, flags, mode);
+  }
+
+  int openat(int dirfd, const char* path, int flags){
+    count(count_open);
+    return ::openat(dirfd, path, flags);
+  }
+
+  long getdents64(int fd, void* buffer, size_t size){
+    count(count_readdir);
+    return syscall(SYS_getdents64, fd, buffer, size);
+  }
+
+  bool exists(const fs::path& path){
+    count(count_stat);
+    return fs::exists(path);
+  }
+
+  uintmax_t file_size(const fs::path& path){
+    count(count_stat);
+    return fs::file_size(path);
+  }
+
+  fs::file_time_type last_write_time(const fs::path& path){
+    count(count_stat);
+    return fs::last_write_time(path);
+  }
+
+  fs::file_status status(const fs::path& path, std::error_code& ec){
+    count(count_stat);
+    return fs::status(path, ec);
+  }
+
+  fs::path canonical(const fs::path& path, std::error_code& ec){
+    count(count_stat);
+    return fs::canonical(path, ec);
+  }
+
+  std::ifstream ifstream(const fs::path& path){
+    count(count_open);
+    return std::ifstream(path);
+  }
+}
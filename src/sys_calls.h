@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_SYS_CALLS_H
+#define SRDP_SYS_CALLS_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <sys/stat.h>
+
+namespace srdp {
+
+  namespace fs = std::filesystem;
+
+  /**
+   * Counted file system calls.
+   *
+   * The workspace scan and verify reach the file system through these
+   * wrappers, so tests can check how many calls an operation makes.
+   * Functions of std::filesystem count as one call, even though they
+   * may make several. Calls made inside scas are not counted.
+   */
+  namespace sys {
+
+    struct counts_t {
+      uint64_t stat = 0;     // stat, lstat, fstat, fstatat, exists, file_size, ...
+      uint64_t open = 0;
+      uint64_t readdir = 0;  // getdents64
+
+      uint64_t total() const { return stat + open + readdir; }
+      counts_t operator-(const counts_t& other) const;
+    };
+
+    // Calls made so far by all threads
+    counts_t get_counts();
+
+    int stat(const char* path, struct stat* st);
+    int lstat(const char* path, struct stat* st);
+    int fstat(int fd, struct stat* st);
+    int fstatat(int dirfd, const char* path, struct stat* st, int flags);
+    int open(const char* path, int flags, mode_t mode = 0);
+    int openat(int dirfd, const char* path, int flags);
+    long getdents64(int fd, void* buffer, size_t size);
+
+    bool exists(const fs::path& path);
+    uintmax_t file_size(const fs::path& path);
+    fs::file_time_type last_write_time(const fs::path& path);
+    fs::file_status status(const fs::path& path, std::error_code& ec);
+    fs::path canonical(const fs::path& path, std::error_code& ec);
+
+    // Open for reading, counted as one open
+    std::ifstream ifstream(const fs::path& path);
+  }
+}
+
+#endif /* SRDP_SYS_CALLS_H */
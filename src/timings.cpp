@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "timings.h"
+#include "sys_calls.h"
+
+namespace srdp {
+
+  struct Timings::node_t {
+    std::string name;
+    std::atomic<int64_t> ns{0};
+    std::atomic<uint64_t> calls{0};
+    std::map<std::string, std::unique_ptr<node_t>> children;
+  };
+
+  const char* Timings::env = "SRDP_TIMINGS";
+
+  static std::atomic<bool> is_enabled(false);
+  static std::once_flag enable_once;
+
+  static std::mutex tree_mutex; // guards the children of all nodes
+  static Timings::node_t root;
+  static thread_local Timings::node_t* current_node = nullptr;
+
+  static std::atomic<uint64_t> counters[size_t(Timings::counter_t::count_)];
+  static std::chrono::steady_clock::time_point start_time;
+  static sys::counts_t start_counts;
+
+  bool Timings::enabled(){
+    return is_enabled.load(std::memory_order_relaxed);
+  }
+
+  void Timings::enable(){
+    if (enabled()) return;
+
+    std::call_once(enable_once, []() {
+        std::atexit([]() { Timings::print(std::cerr); });
+      });
+
+    for (auto& counter : counters)
+      counter = 0;
+
+    start_time = std::chrono::steady_clock::now();
+    start_counts = sys::get_counts();
+    is_enabled = true;
+  }
+
+  void Timings::disable(){
+    is_enabled = false;
+  }
+
+  // Library users enable the timings through the environment
+  static const bool enabled_by_env = []() {
+    const char* value = std::getenv(Timings::env);
+    if (value && *value && std::string(value) != "0")
+      Timings::enable();
+    return true;
+  }();
+
+  void Timings::add(counter_t counter, uint64_t n){
+    if (!enabled()) return;
+    counters[size_t(counter)].fetch_add(n, std::memory_order_relaxed);
+  }
+
+  Timings::node_t* Timings::current(){
+    return current_node;
+  }
+
+  Timings::Span::Span(const char* name){
+    if (!enabled()) return;
+
+    node_t* parent = current_node ? current_node : &root;
+    {
+      std::lock_guard<std::mutex> lock(tree_mutex);
+      auto& child = parent->children[name];
+      if (!child) {
+        child = std::make_unique<node_t>();
+        child->name = name;
+      }
+      node = child.get();
+    }
+
+    previous = current_node;
+    current_node = node;
+    start = std::chrono::steady_clock::now();
+  }
+
+  Timings::Span::~Span(){
+    if (!node) return;
+
+    const auto end = std::chrono::steady_clock::now();
+    node->ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(),
+        std::memory_order_relaxed);
+    node->calls.fetch_add(1, std::memory_order_relaxed);
+
+    current_node = previous;
+  }
+
+  Timings::Adopt::Adopt(node_t* node) : previous(current_node) {
+    current_node = node;
+  }
+
+  Timings::Adopt::~Adopt(){
+    current_node = previous;
+  }
+
+  static void print_node(std::ostream& out, const Timings::node_t& node, int depth){
+    out << std::left << std::setw(40) << std::string(2 * depth, ' ') + node.name
+      << std::right << std::setw(12) << double(node.ns) / 1e6 << " ms"
+      << std::setw(10) << node.calls << " calls\n";
+
+    // Most expensive first
+    std::vector<const Timings::node_t*> children;
+    for (const auto& child : node.children)
+      children.push_back(child.second.get());
+
+    std::stable_sort(children.begin(), children.end(),
+        [](const auto* a, const auto* b) { return a->ns > b->ns; });
+
+    for (const auto* child : children)
+      print_node(out, *child, depth + 1);
+  }
+
+  void Timings::print(std::ostream& out){
+    if (!enabled()) return;
+
+    const auto wall = std::chrono::steady_clock::now() - start_time;
+    const auto fs_calls = sys::get_counts() - start_counts;
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(3);
+    report << "Timings (spans of parallel threads add up):\n";
+    report << std::left << std::setw(40) << "  total" << std::right << std::setw(12)
+      << std::chrono::duration<double, std::milli>(wall).count() << " ms\n";
+
+    {
+      std::lock_guard<std::mutex> lock(tree_mutex);
+      std::vector<const node_t*> children;
+      for (const auto& child : root.children)
+        children.push_back(child.second.get());
+
+      std::stable_sort(children.begin(), children.end(),
+          [](const auto* a, const auto* b) { return a->ns > b->ns; });
+
+      for (const auto* child : children)
+        print_node(report, *child, 2);
+    }
+
+    auto counter = [&](const char* name, uint64_t value) {
+      report << std::left << std::setw(40) << std::string("  ") + name
+        << std::right << std::setw(12) << value << "\n";
+    };
+
+    report << "Counters:\n";
+    counter("queries", counters[size_t(counter_t::queries)]);
+    counter("rows", counters[size_t(counter_t::rows)]);
+    counter("bytes hashed", counters[size_t(counter_t::bytes_hashed)]);
+    counter("bytes copied", counters[size_t(counter_t::bytes_copied)]);
+    counter("stats", fs_calls.stat);
+    counter("opens", fs_calls.open);
+    counter("directory reads", fs_calls.readdir);
+
+    out << report.str();
+  }
+}
@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_TIMINGS_H
+#define SRDP_TIMINGS_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace srdp {
+
+  /**
+   * Hierarchical timing spans and counters.
+   *
+   * Disabled by default, enabled by enable() (dp --timings) or by the
+   * environment variable SRDP_TIMINGS. Each span adds its duration to a
+   * node of a tree, below the span that is open on the same thread.
+   * The tree and the counters are printed to stderr at exit.
+   * A disabled span costs one atomic load.
+   */
+  class Timings {
+    public:
+      struct node_t;
+
+      enum class counter_t {
+        queries,
+        rows,
+        bytes_hashed,
+        bytes_copied,
+        count_
+      };
+
+      static const char* env;
+
+      static bool enabled();
+
+      // Start recording, the report is printed at exit.
+      // Call before other threads record spans.
+      static void enable();
+
+      // Stop recording, no report is printed at exit
+      static void disable();
+
+      static void add(counter_t counter, uint64_t n = 1);
+
+      // Print the tree and the counters
+      static void print(std::ostream& out);
+
+      // Span open on this thread, to be adopted by worker threads
+      static node_t* current();
+
+      class Span {
+        private:
+          node_t* node = nullptr;
+          node_t* previous = nullptr;
+          std::chrono::steady_clock::time_point start;
+
+        public:
+          Span(const char* name);
+          ~Span();
+
+          Span(const Span&) = delete;
+          Span& operator=(const Span&) = delete;
+      };
+
+      // Attach the spans of this thread below node
+      class Adopt {
+        private:
+          node_t* previous;
+
+        public:
+          Adopt(node_t* node);
+          ~Adopt();
+
+          Adopt(const Adopt&) = delete;
+          Adopt& operator=(const Adopt&) = delete;
+      };
+  };
+}
+
+#endif /* SRDP_TIMINGS_H */
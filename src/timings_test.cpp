@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <sstream>
+#include <thread>
+#include <catch2/catch_test_macros.hpp>
+
+#include "timings.h"
+
+TEST_CASE("Timings", "[timings]") {
+  using srdp::Timings;
+
+  SECTION("Disabled spans are not recorded") {
+    REQUIRE_FALSE( Timings::enabled() );
+    {
+      Timings::Span span("test.disabled");
+      REQUIRE( Timings::current() == nullptr );
+    }
+
+    std::ostringstream out;
+    Timings::print(out);
+    REQUIRE( out.str().empty() );
+  }
+
+  SECTION("Spans form a tree") {
+    Timings::enable();
+    REQUIRE( Timings::enabled() );
+
+    {
+      Timings::Span outer("test.outer");
+      for (int i=0; i < 3; i++)
+        Timings::Span inner("test.inner");
+
+      // Worker threads attach below the span that started them
+      auto parent = Timings::current();
+      std::thread worker([parent]() {
+          Timings::Adopt adopt(parent);
+          Timings::Span span("test.worker");
+        });
+      worker.join();
+    }
+
+    Timings::add(Timings::counter_t::bytes_copied, 42);
+
+    std::ostringstream out;
+    Timings::print(out);
+    Timings::disable();
+
+    const std::string report = out.str();
+    REQUIRE( report.find("\n    test.outer") != std::string::npos );
+    REQUIRE( report.find("\n      test.inner") != std::string::npos );
+    REQUIRE( report.find("3 calls") != std::string::npos );
+    REQUIRE( report.find("\n      test.worker") != std::string::npos );
+    REQUIRE( report.find("bytes copied") != std::string::npos );
+    REQUIRE( report.find("42\n") != std::string::npos );
+    REQUIRE_FALSE( report.find("test.disabled") != std::string::npos );
+  }
+}
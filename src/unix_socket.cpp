@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "unix_socket.h"
+
+namespace srdp {
+  namespace unix_socket {
+
+    static bool make_address(const fs::path& path, struct sockaddr_un& addr){
+      std::memset(&addr, 0, sizeof(addr));
+      addr.sun_family = AF_UNIX;
+      if (path.string().size() >= sizeof(addr.sun_path)) return false;
+      std::strcpy(addr.sun_path, path.c_str());
+      return true;
+    }
+
+    int connect(const fs::path& path){
+      struct sockaddr_un addr;
+      if (!make_address(path, addr)) return -1;
+
+      const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+      if (fd == -1) return -1;
+
+      if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+      }
+
+      return fd;
+    }
+
+    int listen(const fs::path& path, const std::string& what){
+      struct sockaddr_un addr;
+      if (!make_address(path, addr))
+        throw std::runtime_error("Socket path is too long: " + path.string());
+
+      const int running = connect(path);
+      if (running != -1) {
+        close(running);
+        throw std::runtime_error(what + " is already running");
+      }
+
+      // Left over from a process that did not exit cleanly
+      fs::remove(path);
+
+      const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+      if (fd == -1)
+        throw std::system_error(errno, std::system_category(), "Can not create socket");
+
+      if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        const int err = errno;
+        close(fd);
+        throw std::system_error(err, std::system_category(), "Can not bind " + path.string());
+      }
+
+      if (::listen(fd, 16) != 0) {
+        const int err = errno;
+        close(fd);
+        fs::remove(path);
+        throw std::system_error(err, std::system_category(), "Can not listen on socket");
+      }
+
+      return fd;
+    }
+
+    bool send_all(int fd, const std::string& data){
+      const char* ptr = data.data();
+      size_t left = data.size();
+      while (left > 0) {
+        const ssize_t n = send(fd, ptr, left, MSG_NOSIGNAL);
+        if (n == -1) {
+          if (errno == EINTR) continue;
+          return false;
+        }
+        ptr += n;
+        left -= n;
+      }
+      return true;
+    }
+
+    void set_timeout(int fd, int seconds){
+      struct timeval tv{seconds, 0};
+      setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+      setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    }
+  }
+}
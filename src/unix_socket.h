@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_UNIX_SOCKET_H
+#define SRDP_UNIX_SOCKET_H
+
+#include <filesystem>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace srdp {
+
+  /**
+   * Helpers for the Unix sockets of the background processes
+   * (dp watch, dp serve) in the config directory.
+   */
+  namespace unix_socket {
+
+    // Connect to the socket, returns -1 if nobody is listening
+    int connect(const fs::path& path);
+
+    /* Bind and listen on the socket.
+     *
+     * Throws if another process is listening on it already.
+     * A socket file left over by a process that did not exit cleanly is replaced.
+     */
+    int listen(const fs::path& path, const std::string& what);
+
+    bool send_all(int fd, const std::string& data);
+
+    // Receive and send timeout
+    void set_timeout(int fd, int seconds);
+  }
+}
+
+#endif /* SRDP_UNIX_SOCKET_H */
@@ -4,6 +4,7 @@
 
 #include <iostream>
 #include "srdp.h"
+#include "output.h"
 
 namespace srdp {
 
@@ -23,7 +24,7 @@ namespace srdp {
     std::cout << "abstract:\n  " << (exp.metadata ? *exp.metadata : "") << "\n";
   };
 
-  void print_file_info(File& f){
+  void print_file_info(const File& f, const std::string& creator){
     std::cout << "path:     " << (f.path ? *f.path : "") << "\n";
     if (f.role)
       std::cout << "role:     " << File::role_to_string(*f.role) << "\n";
@@ -34,12 +35,84 @@ namespace srdp {
     std::cout << "owner:    " << (f.owner ? *f.owner : "") << "\n";
     std::cout << "ctime:   "  << (f.ctime ? Srdp::get_time_stamp_fmt(*f.ctime) : "") << "\n";
     if (f.creator_uuid)
-      std::cout << "creator:  " << f.resolve_creator() << "\n";
+      std::cout << "creator:  " << creator << "\n";
     if (f.metadata)
       std::cout << "metadata: " << *f.metadata << "\n\n";
     std::cout << "\n";
   };
 
+  // Stream a journal page by page
+  void print_journal(Journal journal){
+    int64_t last = 0;
+
+    for (auto page = journal.read(); !page.empty(); page = journal.read(last)) {
+      for (const auto& entry : page)
+        std::cout << entry.text;
+      last = page.back().id;
+    }
+
+    std::cout << "\n";
+  };
+
+  void print_file_info(File& f){
+    print_file_info(f, f.creator_uuid ? f.resolve_creator() : std::string());
+  };
+
+  std::string_view bytes_view(const uuids::uuid& uuid){
+    return std::string_view(reinterpret_cast<const char*>(uuid.data), uuid.size());
+  }
+
+  std::string_view bytes_view(const scas::Hash::hash_t& hash){
+    return std::string_view(reinterpret_cast<const char*>(hash.data()), hash.size());
+  }
+
+  // Machine readable records, same fields in every record of a listing
+  void write_project(OutputWriter& out, const Project& prj){
+    out.begin_record();
+    out.uuid_field("uuid", bytes_view(prj.uuid));
+    out.field("name", prj.name);
+    out.field("owner", prj.owner);
+    out.field("ctime", prj.ctime);
+    out.field("abstract", prj.metadata);
+    out.end_record();
+  };
+
+  void write_experiment(OutputWriter& out, const Experiment& exp){
+    out.begin_record();
+    out.uuid_field("project", bytes_view(exp.project));
+    out.uuid_field("uuid", bytes_view(exp.uuid));
+    out.field("name", exp.name);
+    out.field("owner", exp.owner);
+    out.field("ctime", exp.ctime);
+    out.field("abstract", exp.metadata);
+    out.end_record();
+  };
+
+  void write_file(OutputWriter& out, const File::view_t& f){
+    out.begin_record();
+    out.hex_field("hash", f.hash);
+    out.field("path", f.path);
+    out.field("role", File::role_to_string(f.role));
+    out.field("size", f.size);
+    out.field("name", f.original_name);
+    out.field("owner", f.owner);
+    out.field("ctime", f.ctime);
+    if (f.creator_uuid)
+      out.uuid_field("creator", *f.creator_uuid);
+    else
+      out.null_field("creator");
+    out.field("metadata", f.metadata);
+    out.end_record();
+  };
+
+  // Print the cursor of the next page, keeps machine readable output clean
+  void write_cursor(OutputWriter& out, const std::string& cursor){
+    if (out.is_human())
+      std::cout << "cursor: " << cursor << "\n";
+    else
+      std::cerr << "cursor: " << cursor << "\n";
+  };
+
   std::string fmt_relative_path(const fs::path& target, const fs::path& base_path) {
     // lexically_relative finds the relative path from basePath to target
     fs::path relative = target.lexically_relative(base_path);
@@ -0,0 +1,161 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <sys/stat.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "verify.h"
+#include "sys_calls.h"
+
+namespace srdp {
+
+  std::vector<size_t> sample_weighted(const std::vector<size_t>& weights, size_t count, uint64_t seed){
+    // Efraimidis-Spirakis: pick the largest keys u^(1/w), compared in log space
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+    std::vector<std::pair<double, size_t>> keys(weights.size());
+    for (size_t i=0; i < weights.size(); i++){
+      double u = dist(rng);
+      while (u == 0.0) u = dist(rng);
+      keys[i] = {std::log(u) / double(std::max<size_t>(weights[i], 1)), i};
+    }
+
+    count = std::min(count, keys.size());
+    auto greater = [](const auto& a, const auto& b) { return a.first > b.first; };
+    std::nth_element(keys.begin(), keys.begin() + count, keys.end(), greater);
+
+    std::vector<size_t> selected(count);
+    for (size_t i=0; i < count; i++)
+      selected[i] = keys[i].second;
+
+    std::sort(selected.begin(), selected.end());
+    return selected;
+  }
+
+  double wilson_upper_bound(size_t failures, size_t samples, double z){
+    if (samples == 0) return 1.0;
+
+    const double n = samples;
+    const double p = failures / n;
+    const double z2 = z * z;
+
+    return std::min(1.0,
+      (p + z2 / (2 * n) + z * std::sqrt(p * (1 - p) / n + z2 / (4 * n * n))) / (1 + z2 / n));
+  }
+
+  void VerifyState::create_table(Sql& db){
+    db.exec(R"(
+        CREATE TABLE IF NOT EXISTS verify_state (
+          uuid BLOB(16) NOT NULL,
+          hash BLOB(32) NOT NULL,
+          verified INTEGER NOT NULL,
+          link_ino INTEGER,
+          link_mtime INTEGER,
+          object_ino INTEGER,
+          object_size INTEGER,
+          object_mtime INTEGER,
+          object_ctime INTEGER,
+          result INTEGER NOT NULL,
+          PRIMARY KEY(uuid, hash),
+          FOREIGN KEY(uuid, hash) REFERENCES file_map(uuid, hash) ON DELETE CASCADE
+        );
+    )");
+  }
+
+  static int64_t timespec_to_ns(const struct timespec& ts){
+    return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+  }
+
+  std::optional<VerifyState::fingerprint_t> VerifyState::fingerprint(const fs::path& path){
+    struct stat lst, ost;
+
+    if (sys::lstat(path.c_str(), &lst) != 0)
+      return {};
+
+    if (sys::stat(path.c_str(), &ost) != 0)
+      return {};
+
+    fingerprint_t fp;
+    fp.link_ino = lst.st_ino;
+    fp.link_mtime = timespec_to_ns(lst.st_mtim);
+    fp.object_ino = ost.st_ino;
+    fp.object_size = ost.st_size;
+    fp.object_mtime = timespec_to_ns(ost.st_mtim);
+    fp.object_ctime = timespec_to_ns(ost.st_ctim);
+
+    return fp;
+  }
+
+  VerifyState::VerifyState(std::shared_ptr<Sql>& dbin) : db(dbin)
+  {
+    if (!db)
+      throw std::runtime_error("Invalid DB pointer.");
+  }
+
+  std::map<VerifyState::key_t, VerifyState::entry_t> VerifyState::load_all(){
+    auto res = db->query(R"(
+        SELECT uuid, hash, verified, link_ino, link_mtime,
+               object_ino, object_size, object_mtime, object_ctime, result
+        FROM verify_state;
+      )",
+       Sql::vec_sql_t{},
+       Sql::vec_sql_t{Sql::blob_t(),  // uuid
+                      Sql::blob_t(),  // hash
+                      int64_t(0),     // verified
+                      int64_t(0),     // link_ino
+                      int64_t(0),     // link_mtime
+                      int64_t(0),     // object_ino
+                      int64_t(0),     // object_size
+                      int64_t(0),     // object_mtime
+                      int64_t(0),     // object_ctime
+                      int(0)});       // result
+
+    std::map<key_t, entry_t> state;
+
+    auto get_int64 = [](const std::optional<Sql::sql_t>& value) -> int64_t {
+      return value ? std::get<int64_t>(*value) : 0;
+    };
+
+    while (res) {
+      auto row = *res;
+
+      entry_t e;
+      e.verified = get_int64(row[2]);
+      e.fingerprint.link_ino = get_int64(row[3]);
+      e.fingerprint.link_mtime = get_int64(row[4]);
+      e.fingerprint.object_ino = get_int64(row[5]);
+      e.fingerprint.object_size = get_int64(row[6]);
+      e.fingerprint.object_mtime = get_int64(row[7]);
+      e.fingerprint.object_ctime = get_int64(row[8]);
+      e.result = row[9] ? result_t(std::get<int>(*row[9])) : result_t::ok;
+
+      state[key_t(blob_to_bin<uuids::uuid>(std::get<Sql::blob_t>(*row[0])),
+                  blob_to_bin<scas::Hash::hash_t>(std::get<Sql::blob_t>(*row[1])))] = e;
+
+      res = db->next_row();
+    }
+
+    return state;
+  }
+
+  void VerifyState::record(const uuids::uuid& experiment, const scas::Hash::hash_t& hash, const entry_t& entry){
+    db->query(R"(
+        INSERT OR REPLACE INTO verify_state
+          (uuid, hash, verified, link_ino, link_mtime, object_ino, object_size, object_mtime, object_ctime, result)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
+      )",
+       Sql::vec_sql_t{bin_to_blob(experiment),
+                      bin_to_blob(hash),
+                      int64_t(entry.verified),
+                      entry.fingerprint.link_ino,
+                      entry.fingerprint.link_mtime,
+                      entry.fingerprint.object_ino,
+                      entry.fingerprint.object_size,
+                      entry.fingerprint.object_mtime,
+                      entry.fingerprint.object_ctime,
+                      int(entry.result)});
+  }
+}
@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_VERIFY_H
+#define SRDP_VERIFY_H
+
+#include <map>
+
+#include "files.h"
+
+namespace srdp {
+
+  struct VerifyOptions {
+    bool incremental = false; // Only re-check new or changed mappings
+    ctime_t max_age = -1;     // Re-check entries older than max_age seconds (< 0 = never)
+
+    // Statistical sampling, enabled if fraction or count are set
+    double sample_fraction = 0;          // Fraction of mapped files to check
+    size_t sample_count = 0;             // Number of mapped files to check
+    std::optional<uint64_t> sample_seed; // Seed for reproducible samples
+    unsigned jobs = 0;                   // Number of threads (0 = auto)
+  };
+
+  /**
+   * Size weighted random sample without replacement.
+   * Returns the indices of the selected weights.
+   */
+  std::vector<size_t> sample_weighted(const std::vector<size_t>& weights, size_t count, uint64_t seed);
+
+  /**
+   * Upper bound of the Wilson score interval for a failure rate
+   * (default z = 1.96, i.e. 95% confidence).
+   */
+  double wilson_upper_bound(size_t failures, size_t samples, double z = 1.96);
+
+  /**
+   * Per file mapping verification state.
+   *
+   * Stores the result of the last check together with
+   * a stat fingerprint of the link and the store object.
+   */
+  class VerifyState {
+    private:
+      std::shared_ptr<Sql> db;
+
+    public:
+      enum class result_t {
+        ok = 0,
+        no_path = 1,
+        missing = 2,
+        not_in_store = 3,
+        wrong_size = 4,
+        corrupt = 5
+      };
+
+      struct fingerprint_t {
+        int64_t link_ino = 0;
+        int64_t link_mtime = 0;   // ns
+        int64_t object_ino = 0;
+        int64_t object_size = 0;
+        int64_t object_mtime = 0; // ns
+        int64_t object_ctime = 0; // ns
+
+        bool operator==(const fingerprint_t& r) const {
+          return link_ino == r.link_ino && link_mtime == r.link_mtime &&
+            object_ino == r.object_ino && object_size == r.object_size &&
+            object_mtime == r.object_mtime && object_ctime == r.object_ctime;
+        }
+        bool operator!=(const fingerprint_t& r) const { return !(*this == r); }
+      };
+
+      struct entry_t {
+        ctime_t verified = 0;
+        fingerprint_t fingerprint;
+        result_t result = result_t::ok;
+      };
+
+      using key_t = std::pair<uuids::uuid, scas::Hash::hash_t>;
+
+      static void create_table(Sql& db);
+
+      // Stat link and link target. Returns empty if link or target do not exist.
+      static std::optional<fingerprint_t> fingerprint(const fs::path& path);
+
+      VerifyState(std::shared_ptr<Sql>& dbin);
+
+      /**
+       * Load the state of all mappings.
+       */
+      std::map<key_t, entry_t> load_all();
+
+      /**
+       * Store the state of a mapping.
+       */
+      void record(const uuids::uuid& experiment, const scas::Hash::hash_t& hash, const entry_t& entry);
+  };
+}
+
+#endif /* SRDP_VERIFY_H */
@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <iostream>
+#include <fstream>
+#include <catch2/catch_test_macros.hpp>
+
+#include "verify.h"
+
+const std::filesystem::path db_path("testv.db");
+
+TEST_CASE("Verify state", "[verify]") {
+  std::shared_ptr<srdp::Sql> db = std::make_shared<srdp::Sql>(db_path);
+
+  REQUIRE_NOTHROW( srdp::Project::create_table(*db) );
+  REQUIRE_NOTHROW( srdp::Experiment::create_table(*db) );
+  REQUIRE_NOTHROW( srdp::File::create_table(*db) );
+  REQUIRE_NOTHROW( srdp::VerifyState::create_table(*db) );
+
+  srdp::Project prj(db, "prj");
+  srdp::Experiment exp(db, prj, "exp");
+
+  scas::Hash hash;
+  hash.update("content");
+
+  srdp::File file(db, exp);
+  file.hash = hash.get_hash_binary();
+  file.size = 7;
+  file.role = srdp::File::role_t::input;
+  file.path = "file";
+  REQUIRE( file.create() );
+
+  srdp::VerifyState state(db);
+  REQUIRE( state.load_all().empty() );
+
+  srdp::VerifyState::entry_t entry;
+  entry.verified = 42;
+  entry.fingerprint.object_size = 7;
+  entry.fingerprint.object_mtime = 5000000000;
+  entry.result = srdp::VerifyState::result_t::wrong_size;
+
+  REQUIRE_NOTHROW( state.record(exp.uuid, file.hash, entry) );
+
+  auto all = state.load_all();
+  REQUIRE( all.size() == 1 );
+
+  auto e = all.at(srdp::VerifyState::key_t(exp.uuid, file.hash));
+  REQUIRE( e.verified == 42 );
+  REQUIRE( e.fingerprint == entry.fingerprint );
+  REQUIRE( e.result == srdp::VerifyState::result_t::wrong_size );
+
+  // Record replaces old state
+  entry.result = srdp::VerifyState::result_t::ok;
+  REQUIRE_NOTHROW( state.record(exp.uuid, file.hash, entry) );
+  REQUIRE( state.load_all().size() == 1 );
+
+  // State is dropped with the mapping
+  REQUIRE_NOTHROW( file.unmap() );
+  REQUIRE( state.load_all().empty() );
+
+  std::filesystem::remove(db_path);
+}
+
+TEST_CASE("Verify fingerprint", "[verify]") {
+  const std::filesystem::path target("testv_target");
+  const std::filesystem::path link("testv_link");
+
+  REQUIRE_FALSE( srdp::VerifyState::fingerprint(link) );
+
+  std::ofstream(target) << "data";
+  std::filesystem::create_symlink(target, link);
+
+  auto fp = srdp::VerifyState::fingerprint(link);
+  REQUIRE( fp );
+  REQUIRE( fp->object_size == 4 );
+  REQUIRE( fp->link_ino != fp->object_ino );
+
+  // Dangling link
+  std::filesystem::remove(target);
+  REQUIRE_FALSE( srdp::VerifyState::fingerprint(link) );
+
+  std::filesystem::remove(link);
+}
+
+TEST_CASE("Verify sampling", "[verify]") {
+  std::vector<size_t> weights{1, 1, 1000000, 1, 1};
+
+  // Reproducible with seed
+  REQUIRE( srdp::sample_weighted(weights, 2, 7) == srdp::sample_weighted(weights, 2, 7) );
+
+  auto sample = srdp::sample_weighted(weights, 2, 7);
+  REQUIRE( sample.size() == 2 );
+  REQUIRE( sample[0] != sample[1] );
+
+  // Heavy element is practically always picked
+  size_t hits = 0;
+  for (uint64_t seed=0; seed < 100; seed++) {
+    auto s = srdp::sample_weighted(weights, 1, seed);
+    if (s[0] == 2) hits++;
+  }
+  REQUIRE( hits > 95 );
+
+  // Sample can not be larger than population
+  REQUIRE( srdp::sample_weighted(weights, 10, 1).size() == weights.size() );
+
+  // Confidence bound
+  REQUIRE( srdp::wilson_upper_bound(0, 0) == 1.0 );
+  REQUIRE( srdp::wilson_upper_bound(0, 1000) < 0.004 );
+  REQUIRE( srdp::wilson_upper_bound(10, 100) > 0.1 );
+  REQUIRE( srdp::wilson_upper_bound(100, 100) > 0.99 );
+}
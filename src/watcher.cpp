@@ -0,0 +1,382 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+
+#include "watcher.h"
+#include "unix_socket.h"
+
+namespace srdp {
+
+  const fs::path Watcher::socket_name = "watch.sock";
+
+  // Events that change the classification of a directory's entries
+  static const uint32_t watch_mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+    | IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_DONT_FOLLOW;
+
+  Watcher::Watcher(Srdp& srdpin) :
+    srdp(srdpin),
+    store(srdpin.get_store_dir()),
+    socket_path(srdpin.get_cfg_dir() / socket_name),
+    stamp(srdpin.get_index_stamp())
+  {
+    try {
+      listen_fd = unix_socket::listen(socket_path, "Watcher");
+
+      inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+      if (inotify_fd == -1)
+        throw std::system_error(errno, std::system_category(), "Can not initialize inotify");
+
+      wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if (wake_fd == -1)
+        throw std::system_error(errno, std::system_category(), "Can not create eventfd");
+
+      scan(srdp.get_top_level_dir());
+    } catch (...) {
+      close_all();
+      throw;
+    }
+  }
+
+  Watcher::~Watcher(){
+    close_all();
+  }
+
+  void Watcher::close_all(){
+    if (listen_fd != -1) {
+      close(listen_fd);
+      listen_fd = -1;
+      std::error_code ec;
+      fs::remove(socket_path, ec);
+    }
+    if (inotify_fd != -1) {
+      close(inotify_fd);
+      inotify_fd = -1;
+    }
+    if (wake_fd != -1) {
+      close(wake_fd);
+      wake_fd = -1;
+    }
+  }
+
+  void Watcher::scan(const fs::path& root){
+    static const std::unordered_set<std::string> no_active_paths;
+    DirWalker walker(1);
+
+    std::vector<fs::path> todo{root};
+
+    while (!todo.empty()) {
+      const fs::path dir = std::move(todo.back());
+      todo.pop_back();
+
+      auto& state = dirs[dir];
+
+      // Watch before reading, changes during the read are not lost
+      if (state.wd == -1) {
+        const int wd = inotify_add_watch(inotify_fd, dir.c_str(), watch_mask);
+        if (wd == -1) {
+          if (errno == ENOSPC)
+            throw std::runtime_error("inotify watch limit reached, increase fs.inotify.max_user_watches");
+          // Directory is gone, its parent receives an event
+          dirs.erase(dir);
+          continue;
+        }
+        state.wd = wd;
+        wd_dirs[wd] = dir;
+      }
+
+      std::list<Srdp::DirEntry> untracked;
+      std::list<Srdp::DirEntry> tracked;
+      std::vector<fs::path> subdirs;
+
+      try {
+        // Only the directory itself is read, subdirectories are handled here
+        walker.walk(dir, [&](unsigned, int dirfd, const fs::path& d, const struct stat& dir_stat,
+              std::vector<DirWalker::Entry>& entries) {
+          WorkspaceIndex::dir_t record;
+          subdirs = srdp.classify_dir(dirfd, d, dir_stat, entries, store, no_active_paths,
+              untracked, tracked, record);
+          return std::vector<fs::path>();
+        });
+      } catch (const fs::filesystem_error& e) {
+        // Directory is gone, its parent receives an event
+        untracked.clear();
+        tracked.clear();
+        subdirs.clear();
+      }
+
+      for (const auto& s : subdirs) {
+        if (dirs.count(s) == 0)
+          todo.push_back(s);
+      }
+
+      state.untracked = std::move(untracked);
+      state.tracked = std::move(tracked);
+      state.subdirs = std::move(subdirs);
+    }
+  }
+
+  void Watcher::remove_unreachable(){
+    std::set<fs::path> reachable;
+    std::vector<fs::path> todo{srdp.get_top_level_dir()};
+
+    while (!todo.empty()) {
+      const fs::path dir = std::move(todo.back());
+      todo.pop_back();
+
+      auto it = dirs.find(dir);
+      if (it == dirs.end() || !reachable.insert(dir).second) continue;
+
+      for (const auto& s : it->second.subdirs)
+        todo.push_back(s);
+    }
+
+    for (auto it = dirs.begin(); it != dirs.end();) {
+      if (reachable.count(it->first) > 0) {
+        ++it;
+        continue;
+      }
+
+      // A moved directory keeps its watch descriptor under the new path
+      auto wd_it = wd_dirs.find(it->second.wd);
+      if (wd_it != wd_dirs.end() && wd_it->second == it->first) {
+        inotify_rm_watch(inotify_fd, it->second.wd);
+        wd_dirs.erase(wd_it);
+      }
+
+      it = dirs.erase(it);
+    }
+  }
+
+  void Watcher::rescan_all(){
+    for (const auto& [wd, dir] : wd_dirs)
+      inotify_rm_watch(inotify_fd, wd);
+
+    wd_dirs.clear();
+    dirs.clear();
+    dirty.clear();
+
+    scan(srdp.get_top_level_dir());
+  }
+
+  bool Watcher::read_events(){
+    alignas(struct inotify_event) char buffer[64 * 1024];
+    bool overflow = false;
+    bool rules_changed = false;
+
+    while (true) {
+      const ssize_t nread = read(inotify_fd, buffer, sizeof(buffer));
+      if (nread == -1) {
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN) break;
+        throw std::system_error(errno, std::system_category(), "Can not read inotify events");
+      }
+
+      for (ssize_t pos = 0; pos < nread;) {
+        auto ev = reinterpret_cast<const struct inotify_event*>(buffer + pos);
+        pos += sizeof(struct inotify_event) + ev->len;
+
+        if (ev->mask & IN_Q_OVERFLOW) {
+          overflow = true;
+          continue;
+        }
+
+        auto it = wd_dirs.find(ev->wd);
+        if (it == wd_dirs.end()) continue;
+
+        if (ev->mask & IN_IGNORED) {
+          // Watch was removed by the kernel (directory deleted)
+          auto dir_it = dirs.find(it->second);
+          if (dir_it != dirs.end()) dir_it->second.wd = -1;
+          wd_dirs.erase(it);
+          continue;
+        }
+
+        // Ignore rules of the whole subtree may have changed
+        if (ev->len > 0) {
+          const std::string name(ev->name);
+          if (name == Srdp::ignore_file_name || name == Srdp::gitignore_file_name)
+            rules_changed = true;
+        }
+
+        dirty.insert(it->second);
+      }
+    }
+
+    return overflow || rules_changed;
+  }
+
+  void Watcher::update(){
+    // Events were lost or ignore rules changed, start over
+    if (read_events()) {
+      srdp.reload_ignore_rules();
+      rescan_all();
+      return;
+    }
+
+    bool tree_changed = false;
+
+    for (const auto& dir : dirty) {
+      auto it = dirs.find(dir);
+      if (it == dirs.end()) continue;
+
+      const auto old_subdirs = it->second.subdirs;
+      scan(dir);
+
+      it = dirs.find(dir);
+      if (it == dirs.end() || it->second.subdirs != old_subdirs)
+        tree_changed = true;
+    }
+
+    dirty.clear();
+
+    if (tree_changed)
+      remove_unreachable();
+  }
+
+  void Watcher::serve(int fd){
+    unix_socket::set_timeout(fd, 5);
+
+    std::string request;
+    char c;
+    while (request.size() < 64) {
+      const ssize_t n = recv(fd, &c, 1, 0);
+      if (n == -1 && errno == EINTR) continue;
+      if (n != 1 || c == '\n') break;
+      request += c;
+    }
+
+    // Probes (e.g. from a second watcher) send nothing
+    if (request.empty()) return;
+
+    if (request != "status " + std::to_string(stamp)) {
+      std::cerr << "Request does not match configuration, restart dp watch after changing the ignore file\n";
+      return;
+    }
+
+    // Events that arrived before the request must be visible in the answer
+    update();
+
+    const auto active_paths = srdp.get_active_paths();
+    const fs::path& top = srdp.get_top_level_dir();
+
+    std::list<Srdp::DirEntry> untracked;
+    std::list<Srdp::DirEntry> tracked;
+    for (const auto& [dir, state] : dirs) {
+      untracked.insert(untracked.end(), state.untracked.begin(), state.untracked.end());
+      for (auto e : state.tracked) {
+        e.is_active = active_paths.count(e.file.lexically_relative(top).string()) > 0;
+        tracked.push_back(std::move(e));
+      }
+    }
+
+    std::string buffer;
+    for (const auto& e : Srdp::merge_file_list(untracked, tracked)) {
+      buffer += e.is_in_store ? (e.is_active ? 'A' : 'T') : 'U';
+      buffer += '\t';
+      buffer += std::to_string(e.mtime.time_since_epoch().count());
+      buffer += '\t';
+      buffer += e.file.lexically_relative(top).string();
+      buffer += '\0';
+
+      if (buffer.size() > (1 << 16)) {
+        if (!unix_socket::send_all(fd, buffer)) return;
+        buffer.clear();
+      }
+    }
+
+    buffer += "E";
+    buffer += '\0';
+    unix_socket::send_all(fd, buffer);
+  }
+
+  void Watcher::run(){
+    struct pollfd fds[3] = {
+      {inotify_fd, POLLIN, 0},
+      {listen_fd, POLLIN, 0},
+      {wake_fd, POLLIN, 0}
+    };
+
+    while (true) {
+      if (poll(fds, 3, -1) == -1) {
+        if (errno == EINTR) continue;
+        throw std::system_error(errno, std::system_category(), "Can not poll");
+      }
+
+      if (fds[2].revents) break;
+
+      if (fds[0].revents & POLLIN) update();
+
+      if (fds[1].revents & POLLIN) {
+        const int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd == -1) continue;
+
+        try {
+          serve(fd);
+        } catch (const std::exception& e) {
+          std::cerr << "Error: " << e.what() << "\n";
+        }
+        close(fd);
+      }
+    }
+  }
+
+  void Watcher::stop(){
+    const uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = write(wake_fd, &one, sizeof(one));
+  }
+
+  std::optional<std::list<Srdp::DirEntry>> Watcher::query(Srdp& srdp){
+    const int fd = unix_socket::connect(srdp.get_cfg_dir() / socket_name);
+    if (fd == -1) return std::nullopt;
+
+    unix_socket::set_timeout(fd, 30);
+
+    std::string data;
+    if (unix_socket::send_all(fd, "status " + std::to_string(srdp.get_index_stamp()) + "\n")) {
+      char buffer[64 * 1024];
+      while (true) {
+        const ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0) break;
+        data.append(buffer, n);
+      }
+    }
+    close(fd);
+
+    std::list<Srdp::DirEntry> files;
+    const fs::path& top = srdp.get_top_level_dir();
+
+    for (size_t pos = 0; pos < data.size();) {
+      const size_t end = data.find('\0', pos);
+      if (end == std::string::npos) break;
+
+      const std::string_view record(data.data() + pos, end - pos);
+      pos = end + 1;
+
+      if (record == "E") return files;
+
+      const size_t tab1 = record.find('\t');
+      const size_t tab2 = record.find('\t', tab1 + 1);
+      if (tab1 != 1 || tab2 == std::string_view::npos) break;
+
+      const char kind = record[0];
+      const int64_t mtime = std::stoll(std::string(record.substr(tab1 + 1, tab2 - tab1 - 1)));
+
+      files.push_back(Srdp::DirEntry{
+          top / record.substr(tab2 + 1),
+          fs::file_time_type(fs::file_time_type::duration(mtime)),
+          kind != 'U',
+          kind == 'A'});
+    }
+
+    // Incomplete answer
+    return std::nullopt;
+  }
+}
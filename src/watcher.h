@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_WATCHER_H
+#define SRDP_WATCHER_H
+
+#include <list>
+#include <map>
+#include <optional>
+#include <set>
+#include <unordered_map>
+
+#include "srdp.h"
+
+namespace srdp {
+
+  /**
+   * Workspace watcher.
+   *
+   * Keeps the classified directory tree in memory and updates it from
+   * inotify events. Only directories that received an event are read
+   * again. The result is served to dp status over a Unix socket in the
+   * config directory.
+   *
+   * Protocol: the client sends "status <stamp>\n" with its index stamp,
+   * the watcher answers with one record per entry,
+   * "<kind>\t<mtime>\t<path>\0", where kind is U (untracked),
+   * T (tracked), or A (tracked, active experiment), and path is relative
+   * to the top level directory, followed by the end record "E\0".
+   * If the stamps differ (e.g. the ignore file was changed) the
+   * connection is closed without an answer.
+   */
+  class Watcher {
+    private:
+      struct dir_state_t {
+        int wd = -1;
+        std::list<Srdp::DirEntry> untracked;
+        std::list<Srdp::DirEntry> tracked;
+        std::vector<fs::path> subdirs;
+      };
+
+      Srdp& srdp;
+      scas::Store store;
+      fs::path socket_path;
+      uint64_t stamp;
+
+      int inotify_fd = -1;
+      int listen_fd = -1;
+      int wake_fd = -1;
+
+      std::map<fs::path, dir_state_t> dirs;
+      std::unordered_map<int, fs::path> wd_dirs;
+      std::set<fs::path> dirty;
+
+      void close_all();
+      void scan(const fs::path& dir);
+      void remove_unreachable();
+      void rescan_all();
+
+      // Returns true if a full rescan is needed
+      bool read_events();
+      void update();
+      void serve(int fd);
+
+    public:
+      static const fs::path socket_name;
+
+      /* Bind the socket and read the initial tree.
+       *
+       * Throws if another watcher is already running.
+       */
+      Watcher(Srdp& srdp);
+      ~Watcher();
+
+      Watcher(const Watcher&) = delete;
+      Watcher& operator=(const Watcher&) = delete;
+
+      size_t size() const { return dirs.size(); }
+
+      // Process events and requests until stop() is called
+      void run();
+
+      // Can be called from another thread or a signal handler
+      void stop();
+
+      /**
+       * Get the file list from a running watcher.
+       *
+       * Returns nothing if no watcher is running or it does not answer.
+       */
+      static std::optional<std::list<Srdp::DirEntry>> query(Srdp& srdp);
+  };
+}
+
+#endif /* SRDP_WATCHER_H */
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <fstream>
+#include <thread>
+#include <catch2/catch_test_macros.hpp>
+
+#include "watcher.h"
+
+static bool has_file(const std::list<srdp::Srdp::DirEntry>& files, const fs::path& path, bool in_store){
+  for (const auto& e : files)
+    if (e.file == path && e.is_in_store == in_store) return true;
+  return false;
+}
+
+TEST_CASE("Watcher", "[watcher]") {
+  const fs::path base_dir = fs::absolute("test_watcher");
+  auto old_cwd = fs::current_path();
+
+  fs::create_directory(base_dir);
+  fs::current_path(base_dir);
+
+  REQUIRE_NOTHROW( srdp::Srdp::init("./") );
+
+  srdp::Srdp dp;
+  REQUIRE_NOTHROW( dp.create_project("project") );
+  REQUIRE_NOTHROW( dp.create_experiment("experiment") );
+  const fs::path top = dp.get_top_level_dir();
+
+  fs::create_directories("sub/deep");
+  std::ofstream("sub/a") << "a";
+
+  // No watcher running
+  REQUIRE_FALSE( srdp::Watcher::query(dp) );
+
+  {
+    // The watcher thread uses its own DB connection
+    srdp::Srdp dp_watch;
+    srdp::Watcher watcher(dp_watch);
+    REQUIRE( watcher.size() == 3 );
+
+    // Only one watcher per project
+    REQUIRE_THROWS( srdp::Watcher(dp) );
+
+    std::thread thread([&watcher]() { watcher.run(); });
+    struct stop_t {
+      srdp::Watcher& watcher;
+      std::thread& thread;
+      ~stop_t() { watcher.stop(); thread.join(); }
+    } stop{watcher, thread};
+
+    auto files = srdp::Watcher::query(dp);
+    REQUIRE( files );
+    REQUIRE( files->size() == 1 );
+    REQUIRE( has_file(*files, top / "sub/a", false) );
+
+    // Changes are visible in the next answer
+    std::ofstream("sub/deep/b") << "b";
+    fs::create_directories("new/dir");
+    std::ofstream("new/dir/c") << "c";
+    fs::remove("sub/a");
+
+    files = srdp::Watcher::query(dp);
+    REQUIRE( files );
+    REQUIRE( files->size() == 2 );
+    REQUIRE( has_file(*files, top / "sub/deep/b", false) );
+    REQUIRE( has_file(*files, top / "new/dir/c", false) );
+
+    // Moved and removed directories
+    fs::rename("new", "moved");
+    fs::remove_all("sub");
+
+    files = srdp::Watcher::query(dp);
+    REQUIRE( files );
+    REQUIRE( files->size() == 1 );
+    REQUIRE( has_file(*files, top / "moved/dir/c", false) );
+
+    // Same answer as a full scan
+    REQUIRE( dp.get_file_list(true, 1, false).size() == files->size() );
+  }
+
+  // Socket is removed on exit
+  REQUIRE_FALSE( fs::exists(dp.get_cfg_dir() / srdp::Watcher::socket_name) );
+  REQUIRE_FALSE( srdp::Watcher::query(dp) );
+
+  fs::current_path(old_cwd);
+  fs::remove_all(base_dir);
+}
@@ -0,0 +1,194 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "workspace_index.h"
+#include "sys_calls.h"
+
+namespace srdp {
+
+  // File layout (native byte order):
+  //   header: magic[8] stamp:u64 ndirs:u64
+  //   dir:    path_len:u32 nentries:u32 mtime:i64 ino:u64 rules:u64 path[path_len] entry[nentries]
+  //   entry:  kind:u8 path_len:u32 mtime:i64 path[path_len]
+  const char WorkspaceIndex::magic[8] = {'S', 'R', 'D', 'P', 'I', 'D', 'X', '2'};
+
+  static const size_t header_size = sizeof(WorkspaceIndex::magic) + 2 * sizeof(uint64_t);
+  static const size_t dir_header_size = 2 * sizeof(uint32_t) + sizeof(int64_t) + 2 * sizeof(uint64_t);
+  static const size_t entry_header_size = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(int64_t);
+
+  template<class T>
+  static T read_value(const char* ptr){
+    T value;
+    std::memcpy(&value, ptr, sizeof(T));
+    return value;
+  }
+
+  template<class T>
+  static void append_value(std::string& buffer, T value){
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  WorkspaceIndex::WorkspaceIndex(const fs::path& index_file, uint64_t stamp){
+    const int fd = sys::open(index_file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return;
+
+    struct stat st;
+    if (sys::fstat(fd, &st) == 0 && size_t(st.st_size) >= header_size) {
+      map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map == MAP_FAILED)
+        map = nullptr;
+      else
+        map_size = st.st_size;
+    }
+    close(fd);
+
+    if (map) {
+      parse(stamp);
+      if (dirs.empty()) {
+        munmap(map, map_size);
+        map = nullptr;
+        map_size = 0;
+      }
+    }
+  }
+
+  WorkspaceIndex::~WorkspaceIndex(){
+    if (map) munmap(map, map_size);
+  }
+
+  void WorkspaceIndex::parse(uint64_t stamp){
+    const char* data = static_cast<const char*>(map);
+    const char* end = data + map_size;
+
+    if (std::memcmp(data, magic, sizeof(magic)) != 0) return;
+    if (read_value<uint64_t>(data + sizeof(magic)) != stamp) return;
+
+    const uint64_t ndirs = read_value<uint64_t>(data + sizeof(magic) + sizeof(uint64_t));
+    const char* ptr = data + header_size;
+
+    for (uint64_t i=0; i < ndirs; i++) {
+      if (end - ptr < ptrdiff_t(dir_header_size)) { dirs.clear(); return; }
+
+      const uint32_t path_len = read_value<uint32_t>(ptr);
+      view_t view;
+      view.nentries = read_value<uint32_t>(ptr + sizeof(uint32_t));
+      view.mtime = read_value<int64_t>(ptr + 2 * sizeof(uint32_t));
+      view.ino = read_value<uint64_t>(ptr + 2 * sizeof(uint32_t) + sizeof(int64_t));
+      view.rules = read_value<uint64_t>(ptr + 2 * sizeof(uint32_t) + sizeof(int64_t) + sizeof(uint64_t));
+      ptr += dir_header_size;
+
+      if (end - ptr < ptrdiff_t(path_len)) { dirs.clear(); return; }
+      std::string_view path(ptr, path_len);
+      ptr += path_len;
+
+      // Skip over entries, they are decoded on lookup
+      view.entries = ptr;
+      for (uint32_t j=0; j < view.nentries; j++) {
+        if (end - ptr < ptrdiff_t(entry_header_size)) { dirs.clear(); return; }
+        const uint32_t entry_len = read_value<uint32_t>(ptr + sizeof(uint8_t));
+        ptr += entry_header_size;
+        if (end - ptr < ptrdiff_t(entry_len)) { dirs.clear(); return; }
+        ptr += entry_len;
+      }
+
+      dirs[path] = view;
+    }
+  }
+
+  bool WorkspaceIndex::lookup(const std::string& dir, int64_t mtime, uint64_t ino, uint64_t rules, dir_t& record) const {
+    auto it = dirs.find(dir);
+    if (it == dirs.end()) return false;
+
+    const view_t& view = it->second;
+    if (view.mtime == 0 || view.mtime != mtime || view.ino != ino || view.rules != rules) return false;
+
+    record.mtime = view.mtime;
+    record.ino = view.ino;
+    record.rules = view.rules;
+    record.entries.clear();
+    record.entries.reserve(view.nentries);
+
+    const char* ptr = view.entries;
+    for (uint32_t j=0; j < view.nentries; j++) {
+      entry_t e;
+      e.kind = kind_t(read_value<uint8_t>(ptr));
+      const uint32_t len = read_value<uint32_t>(ptr + sizeof(uint8_t));
+      e.mtime = read_value<int64_t>(ptr + sizeof(uint8_t) + sizeof(uint32_t));
+      ptr += entry_header_size;
+      e.path.assign(ptr, len);
+      ptr += len;
+      record.entries.push_back(std::move(e));
+    }
+
+    return true;
+  }
+
+  void WorkspaceIndex::write(const fs::path& index_file, uint64_t stamp, const std::map<std::string, dir_t>& dirs){
+    fs::path tmp_file = index_file;
+    tmp_file += ".tmp" + std::to_string(getpid());
+
+    const int fd = sys::open(tmp_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1)
+      throw fs::filesystem_error("Can not write index", tmp_file, std::error_code(errno, std::system_category()));
+
+    std::string buffer;
+
+    auto flush = [&]() {
+      const char* ptr = buffer.data();
+      size_t left = buffer.size();
+      while (left > 0) {
+        const ssize_t n = ::write(fd, ptr, left);
+        if (n == -1) {
+          if (errno == EINTR) continue;
+          const int err = errno;
+          close(fd);
+          fs::remove(tmp_file);
+          throw fs::filesystem_error("Can not write index", tmp_file, std::error_code(err, std::system_category()));
+        }
+        ptr += n;
+        left -= n;
+      }
+      buffer.clear();
+    };
+
+    buffer.append(magic, sizeof(magic));
+    append_value<uint64_t>(buffer, stamp);
+    append_value<uint64_t>(buffer, dirs.size());
+
+    for (const auto& [path, dir] : dirs) {
+      append_value<uint32_t>(buffer, path.size());
+      append_value<uint32_t>(buffer, dir.entries.size());
+      append_value<int64_t>(buffer, dir.mtime);
+      append_value<uint64_t>(buffer, dir.ino);
+      append_value<uint64_t>(buffer, dir.rules);
+      buffer.append(path);
+
+      for (const auto& e : dir.entries) {
+        append_value<uint8_t>(buffer, uint8_t(e.kind));
+        append_value<uint32_t>(buffer, e.path.size());
+        append_value<int64_t>(buffer, e.mtime);
+        buffer.append(e.path);
+      }
+
+      if (buffer.size() > (1 << 20)) flush();
+    }
+
+    flush();
+
+    const int sync_rc = fsync(fd);
+    const int close_rc = close(fd);
+    if (sync_rc != 0 || close_rc != 0) {
+      fs::remove(tmp_file);
+      throw fs::filesystem_error("Can not write index", tmp_file, std::error_code(errno, std::system_category()));
+    }
+
+    fs::rename(tmp_file, index_file);
+  }
+}
@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef SRDP_WORKSPACE_INDEX_H
+#define SRDP_WORKSPACE_INDEX_H
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace srdp {
+
+  namespace fs = std::filesystem;
+
+  /**
+   * Persistent cache of the classified directory tree.
+   *
+   * For every directory the index holds its mtime and inode together with
+   * the classified entries found in it. A directory whose mtime and inode
+   * are unchanged does not need to be read again. The file is memory mapped
+   * for reading and replaced atomically on write.
+   *
+   * File mtimes stored in the index are those of the last time the
+   * directory was read.
+   */
+  class WorkspaceIndex {
+    public:
+      enum class kind_t : uint8_t {
+        untracked = 0,
+        tracked = 1,
+        subdir = 2
+      };
+
+      struct entry_t {
+        kind_t kind;
+        int64_t mtime;    // fs::file_time_type tick count
+        std::string path; // relative to top level directory
+      };
+
+      struct dir_t {
+        int64_t mtime = 0; // ns, 0 = do not reuse
+        uint64_t ino = 0;
+        uint64_t rules = 0; // fingerprint of the ignore rules applied
+        std::vector<entry_t> entries;
+      };
+
+      static const char magic[8];
+
+    private:
+      struct view_t {
+        int64_t mtime;
+        uint64_t ino;
+        uint64_t rules;
+        uint32_t nentries;
+        const char* entries;
+      };
+
+      void* map = nullptr;
+      size_t map_size = 0;
+
+      // Directory path relative to top level directory -> record in map
+      std::unordered_map<std::string_view, view_t> dirs;
+
+      void parse(uint64_t stamp);
+
+    public:
+      /* Map the index file.
+       *
+       * Stays empty if the file does not exist, is corrupt,
+       * or was written with a different stamp.
+       */
+      WorkspaceIndex(const fs::path& index_file, uint64_t stamp);
+      ~WorkspaceIndex();
+
+      WorkspaceIndex(const WorkspaceIndex&) = delete;
+      WorkspaceIndex& operator=(const WorkspaceIndex&) = delete;
+
+      size_t size() const { return dirs.size(); }
+
+      /**
+       * Get the record of a directory if mtime, inode, and ignore rules match.
+       */
+      bool lookup(const std::string& dir, int64_t mtime, uint64_t ino, uint64_t rules, dir_t& record) const;
+
+      /**
+       * Write a new index file and atomically replace the old one.
+       */
+      static void write(const fs::path& index_file, uint64_t stamp, const std::map<std::string, dir_t>& dirs);
+  };
+}
+
+#endif /* SRDP_WORKSPACE_INDEX_H */
@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2026 Markus Kowalewski
+//
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <fstream>
+#include <catch2/catch_test_macros.hpp>
+
+#include "workspace_index.h"
+
+const std::filesystem::path index_path("test_index");
+
+TEST_CASE("Workspace index", "[workspace_index]") {
+  using srdp::WorkspaceIndex;
+
+  std::map<std::string, WorkspaceIndex::dir_t> dirs;
+  dirs["."] = WorkspaceIndex::dir_t{100, 1, 9, {
+    {WorkspaceIndex::kind_t::untracked, 5, "file"},
+    {WorkspaceIndex::kind_t::subdir, 0, "dir"}}};
+  dirs["dir"] = WorkspaceIndex::dir_t{200, 2, 9, {
+    {WorkspaceIndex::kind_t::tracked, 7, "dir/data"}}};
+  dirs["racy"] = WorkspaceIndex::dir_t{0, 3, 9, {}};
+
+  // Missing file gives an empty index
+  REQUIRE( WorkspaceIndex(index_path, 1).size() == 0 );
+
+  REQUIRE_NOTHROW( WorkspaceIndex::write(index_path, 1, dirs) );
+
+  WorkspaceIndex index(index_path, 1);
+  REQUIRE( index.size() == 3 );
+
+  WorkspaceIndex::dir_t record;
+  REQUIRE( index.lookup(".", 100, 1, 9, record) );
+  REQUIRE( record.entries.size() == 2 );
+  REQUIRE( record.entries[0].kind == WorkspaceIndex::kind_t::untracked );
+  REQUIRE( record.entries[0].mtime == 5 );
+  REQUIRE( record.entries[0].path == "file" );
+  REQUIRE( record.entries[1].kind == WorkspaceIndex::kind_t::subdir );
+
+  REQUIRE( index.lookup("dir", 200, 2, 9, record) );
+  REQUIRE( record.entries.size() == 1 );
+  REQUIRE( record.entries[0].path == "dir/data" );
+
+  // Changed directories and racy entries are not reused
+  REQUIRE_FALSE( index.lookup("dir", 201, 2, 9, record) );
+  REQUIRE_FALSE( index.lookup("dir", 200, 3, 9, record) );
+  REQUIRE_FALSE( index.lookup("racy", 0, 3, 9, record) );
+  REQUIRE_FALSE( index.lookup("other", 100, 1, 9, record) );
+
+  // Changed ignore rules
+  REQUIRE_FALSE( index.lookup("dir", 200, 2, 8, record) );
+
+  // Stamp mismatch invalidates the whole index
+  REQUIRE( WorkspaceIndex(index_path, 2).size() == 0 );
+
+  // Truncated file is rejected
+  std::filesystem::resize_file(index_path, std::filesystem::file_size(index_path) - 4);
+  REQUIRE( WorkspaceIndex(index_path, 1).size() == 0 );
+
+  std::filesystem::remove(index_path);
+}